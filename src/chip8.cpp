@@ -1,13 +1,25 @@
 #include "chip8.hpp"
-#include <fstream>
+#include "debugger.hpp"
 #include <cstring>
+#ifndef CHIP8_FREESTANDING
+#include <fstream>
 #include <stdio.h>
 #include <iostream>
+#include <chrono>
+#endif
 
 const unsigned int FONTSET_SIZE = 80;
 const unsigned int FONSTSET_START_ADDRESS = 0x050;
+const unsigned int BIG_FONTSET_SIZE = 160;
+const unsigned int BIG_FONTSET_START_ADDRESS = 0x0A0;
 const unsigned int START_ADDRESS = 0x200;
 
+// Every guest address and stack slot is wrapped with these masks so
+// a ROM can never reach outside of the machine. Address mask comes
+// from memory size of the quirk profile
+const unsigned int STACK_MASK = STACK_SIZE - 1;
+const unsigned int KEYPAD_MASK = KEYPAD_SIZE - 1;
+
 // 16 chars 5 byte each
 uint8_t fontset[FONTSET_SIZE] =
     {
@@ -29,20 +41,91 @@ uint8_t fontset[FONTSET_SIZE] =
         0xF0, 0x80, 0xF0, 0x80, 0x80  // F
 };
 
-Chip8::Chip8()
+// SUPER-CHIP 8x10 digits, XO-CHIP adds A-F
+uint8_t bigFontset[BIG_FONTSET_SIZE] =
+    {
+        0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, // 0
+        0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, // 1
+        0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // 2
+        0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 3
+        0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, // 4
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 5
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 6
+        0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18, // 7
+        0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 8
+        0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 9
+        0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, // A
+        0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, // B
+        0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C, // C
+        0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, // D
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // E
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0  // F
+};
+
+// Colors for pixels lit in none, first, second and both planes
+const uint32_t videoPalette[1u << VIDEO_PLANES] = {0x00000000, 0xFFFFFFFF, 0xAAAAAAFF, 0x555555FF};
+
+Chip8Base::Chip8Base(unsigned int memorySize, uint8_t *memory)
+    : memory(memory), memorySize(memorySize),
+#ifdef CHIP8_FREESTANDING
+      randGen(Chip8Hooks::Entropy())
+#else
+      randGen(std::chrono::system_clock::now().time_since_epoch().count())
+#endif
+{
+};
+
+/** @brief Put machine back into its power on state in place so a ROM can be
+ *         loaded again without recreating it. Quirks and random generator
+ *         stay, and so do SUPER-CHIP flags which stand for storage that
+ *         outlives a program
+ */
+void Chip8Base::Reset()
 {
+    std::memset(registers, 0, sizeof(registers));
+    std::memset(memory, 0, memorySize);
+    std::memset(stack, 0, sizeof(stack));
+    std::memset(keypad, 0, sizeof(keypad));
+    std::memset(video, 0, sizeof(video));
+    std::memset(audioPattern, 0, sizeof(audioPattern));
+    index = 0;
     pc = START_ADDRESS;
+    sp = 0;
+    delayTimer = 0;
+    soundTimer = 0;
+    opcode = 0;
+    outOfRange = 0;
+    unknownOpcodes = 0;
+    instructions = 0;
+    hires = false;
+    planes = 0x1;
+    pitch = 0;
+
     for (unsigned int i = 0; i < FONTSET_SIZE; ++i)
     {
         memory[FONSTSET_START_ADDRESS + i] = fontset[i];
     };
+    for (unsigned int i = 0; i < BIG_FONTSET_SIZE; ++i)
+    {
+        memory[BIG_FONTSET_START_ADDRESS + i] = bigFontset[i];
+    };
+};
+
+Chip8Base::~Chip8Base() = default;
+
+template <typename Quirks>
+Chip8<Quirks>::Chip8()
+    : Chip8Base(Quirks::memorySize, storage)
+{
+    // Memory belongs to this class, so it is set up here rather than by Chip8Base
+    Reset();
 
     table[0x0] = &Chip8::Table0;
     table[0x1] = &Chip8::OP_1nnn;
     table[0x2] = &Chip8::OP_2nnn;
     table[0x3] = &Chip8::OP_3xkk;
     table[0x4] = &Chip8::OP_4xkk;
-    table[0x5] = &Chip8::OP_5xy0;
+    table[0x5] = Quirks::xoChip ? &Chip8::Table5 : &Chip8::OP_5xy0;
     table[0x6] = &Chip8::OP_6xkk;
     table[0x7] = &Chip8::OP_7xkk;
     table[0x8] = &Chip8::Table8;
@@ -55,15 +138,16 @@ Chip8::Chip8()
     table[0xF] = &Chip8::TableF;
 
     // One unique Tables
-    for (size_t i = 0; i <= 0xE; i++)
+    for (size_t i = 0; i <= 0xF; i++)
     {
-        table0[i] = &Chip8::OP_NULL;
+        table5[i] = &Chip8::OP_NULL;
         table8[i] = &Chip8::OP_NULL;
         tableE[i] = &Chip8::OP_NULL;
     }
 
-    table0[0x0] = &Chip8::OP_00E0;
-    table0[0xE] = &Chip8::OP_00EE;
+    table5[0x0] = &Chip8::OP_5xy0;
+    table5[0x2] = &Chip8::OP_5xy2;
+    table5[0x3] = &Chip8::OP_5xy3;
 
     table8[0x0] = &Chip8::OP_8xy0;
     table8[0x1] = &Chip8::OP_8xy1;
@@ -79,11 +163,15 @@ Chip8::Chip8()
     tableE[0xE] = &Chip8::OP_Ex9E;
 
     // Doubly Unique Tables
-    for (size_t i = 0; i <= 0x65; i++)
+    for (size_t i = 0; i <= 0xFF; i++)
     {
+        table0[i] = &Chip8::OP_NULL;
         tableF[i] = &Chip8::OP_NULL;
     }
 
+    table0[0xE0] = &Chip8::OP_00E0;
+    table0[0xEE] = &Chip8::OP_00EE;
+
     tableF[0x07] = &Chip8::OP_Fx07;
     tableF[0x0A] = &Chip8::OP_Fx0A;
     tableF[0x15] = &Chip8::OP_Fx15;
@@ -93,136 +181,614 @@ Chip8::Chip8()
     tableF[0x33] = &Chip8::OP_Fx33;
     tableF[0x55] = &Chip8::OP_Fx55;
     tableF[0x65] = &Chip8::OP_Fx65;
+
+    if constexpr (Quirks::superChip)
+    {
+        for (size_t i = 0; i <= 0xF; i++)
+        {
+            table0[0xC0 + i] = &Chip8::OP_00Cn;
+        }
+        table0[0xFB] = &Chip8::OP_00FB;
+        table0[0xFC] = &Chip8::OP_00FC;
+        table0[0xFD] = &Chip8::OP_00FD;
+        table0[0xFE] = &Chip8::OP_00FE;
+        table0[0xFF] = &Chip8::OP_00FF;
+
+        tableF[0x30] = &Chip8::OP_Fx30;
+        tableF[0x75] = &Chip8::OP_Fx75;
+        tableF[0x85] = &Chip8::OP_Fx85;
+    }
+
+    if constexpr (Quirks::xoChip)
+    {
+        for (size_t i = 0; i <= 0xF; i++)
+        {
+            table0[0xD0 + i] = &Chip8::OP_00Dn;
+        }
+
+        tableF[0x00] = &Chip8::OP_F000;
+        tableF[0x01] = &Chip8::OP_Fn01;
+        tableF[0x02] = &Chip8::OP_F002;
+        tableF[0x3A] = &Chip8::OP_Fx3A;
+    }
 };
 
-void Chip8::Table0()
+/// @brief Copy of machine with memory pointer moved to its own storage
+template <typename Quirks>
+Chip8<Quirks>::Chip8(const Chip8 &other)
+    : Chip8Base(other)
 {
-    ((*this).*(table0[opcode & 0x000Fu]))();
+    memory = storage;
+    std::memcpy(storage, other.storage, sizeof(storage));
+    std::memcpy(table, other.table, sizeof(table));
+    std::memcpy(table0, other.table0, sizeof(table0));
+    std::memcpy(table5, other.table5, sizeof(table5));
+    std::memcpy(table8, other.table8, sizeof(table8));
+    std::memcpy(tableE, other.tableE, sizeof(tableE));
+    std::memcpy(tableF, other.tableF, sizeof(tableF));
+}
+
+template <typename Quirks>
+void Chip8<Quirks>::Table0()
+{
+    ((*this).*(table0[opcode & 0x00FFu]))();
 };
 
-void Chip8::Table8()
+template <typename Quirks>
+void Chip8<Quirks>::Table5()
+{
+    ((*this).*(table5[opcode & 0x000Fu]))();
+}
+
+template <typename Quirks>
+void Chip8<Quirks>::Table8()
 {
     ((*this).*(table8[opcode & 0x000Fu]))();
 }
 
-void Chip8::TableE()
+template <typename Quirks>
+void Chip8<Quirks>::TableE()
 {
     ((*this).*(tableE[opcode & 0x000Fu]))();
 }
 
-void Chip8::TableF()
+template <typename Quirks>
+void Chip8<Quirks>::TableF()
 {
     ((*this).*(tableF[opcode & 0x00FFu]))();
 }
 
-void Chip8::OP_NULL()
+template <typename Quirks>
+void Chip8<Quirks>::OP_NULL()
 {
+    ++unknownOpcodes;
+#ifdef CHIP8_FREESTANDING
+    Chip8Hooks::UnknownOpcode(opcode);
+#elif defined(CHIP8_TRACE)
     std::cout << "DEBUG: "
               << "Unrecognized opcode NULL" << std::endl;
+#endif
+}
+
+/// @brief Wrap guest address into memory and count it if it was out of range
+template <typename Quirks>
+uint16_t Chip8<Quirks>::Address(unsigned int address)
+{
+    outOfRange += address > Quirks::memorySize - 1;
+    return Wrap(address);
+}
+
+/// @brief Address as memory sees it, without counting it as an access
+template <typename Quirks>
+uint16_t Chip8<Quirks>::Wrap(unsigned int address) const
+{
+    return address & (Quirks::memorySize - 1);
+}
+
+/// @brief Data read, seen by debugger in Debugged profiles
+template <typename Quirks>
+uint8_t Chip8<Quirks>::Load(unsigned int address)
+{
+    uint16_t wrapped = Address(address);
+    if constexpr (Quirks::debug)
+    {
+        if (debugger)
+        {
+            debugger->MemoryAccess(wrapped, WATCH_READ);
+        }
+    }
+    return memory[wrapped];
+}
+
+/// @brief Data write, seen by debugger in Debugged profiles
+template <typename Quirks>
+uint8_t &Chip8<Quirks>::Store(unsigned int address)
+{
+    uint16_t wrapped = Address(address);
+    if constexpr (Quirks::debug)
+    {
+        if (debugger)
+        {
+            debugger->MemoryAccess(wrapped, WATCH_WRITE);
+        }
+    }
+    return memory[wrapped];
+}
+
+/// @brief Skip next instruction, on XO-CHIP the four byte F000 counts as one
+template <typename Quirks>
+void Chip8<Quirks>::SkipNext()
+{
+    if constexpr (Quirks::xoChip)
+    {
+        uint16_t next = (memory[Address(pc)] << 8u) | memory[Address(pc + 1)];
+        if (next == 0xF000)
+        {
+            pc += 2;
+        }
+    }
+    pc += 2;
+}
+
+/// @brief Bits of a video row that are visible in current resolution
+template <typename Quirks>
+VideoRow Chip8<Quirks>::WidthMask() const
+{
+    return hires ? ~VideoRow{0} : ~VideoRow{0} << (HIRES_VIDEO_WIDTH - VIDEO_WIDTH);
+}
+
+/** @brief Expand framebuffer into RGBA pixels of size HIRES_VIDEO_WIDTH x
+ *         HIRES_VIDEO_HEIGHT. Lo-res pixels are doubled in both directions
+ */
+void Chip8Base::RenderVideo(uint32_t *pixels) const
+{
+    unsigned int shift = hires ? 0 : 1;
+    for (unsigned int y = 0; y < HIRES_VIDEO_HEIGHT; ++y)
+    {
+        VideoRow first = video[0][y >> shift];
+        VideoRow second = video[1][y >> shift];
+        for (unsigned int x = 0; x < HIRES_VIDEO_WIDTH; ++x)
+        {
+            unsigned int bit = HIRES_VIDEO_WIDTH - 1 - (x >> shift);
+            unsigned int color = ((first >> bit) & 0x1u) | (((second >> bit) & 0x1u) << 1);
+            pixels[x + y * HIRES_VIDEO_WIDTH] = videoPalette[color];
+        }
+    }
+}
+
+/// @brief Number of memory, stack and keypad accesses that had to be wrapped
+uint32_t Chip8Base::OutOfRangeAccesses() const
+{
+    return outOfRange;
+}
+
+/// @brief Number of instructions that ran into OP_NULL
+uint32_t Chip8Base::UnknownOpcodes() const
+{
+    return unknownOpcodes;
+}
+
+/// @brief Number of instructions run, ticks a debugger held the machine for do not count
+uint32_t Chip8Base::Instructions() const
+{
+    return instructions;
+}
+
+/// @brief Read only views of machine state that avoid copying it
+const uint8_t *Chip8Base::Registers() const
+{
+    return registers;
+}
+
+const uint8_t *Chip8Base::Memory() const
+{
+    return memory;
+}
+
+/// @brief Bytes behind Memory(), as many as the profile addresses
+unsigned int Chip8Base::MemorySize() const
+{
+    return memorySize;
+}
+
+uint16_t Chip8Base::Index() const
+{
+    return index;
+}
+
+uint16_t Chip8Base::PC() const
+{
+    return pc;
+}
+
+uint8_t Chip8Base::DelayTimer() const
+{
+    return delayTimer;
+}
+
+uint8_t Chip8Base::SoundTimer() const
+{
+    return soundTimer;
+}
+
+bool Chip8Base::Hires() const
+{
+    return hires;
+}
+
+/// @brief Hand breakpoints and watchpoints to machine, nullptr detaches
+void Chip8Base::Attach(Debugger *debugger)
+{
+    this->debugger = debugger;
+}
+
+/// @brief Opcode stored at address, wrapped like fetches but without counting
+uint16_t Chip8Base::OpcodeAt(unsigned int address) const
+{
+    const unsigned int addressMask = memorySize - 1;
+    return (memory[address & addressMask] << 8u) | memory[(address + 1) & addressMask];
+}
+
+/** @brief Count timers down by ticks without running anything, for callers
+ *         that know those ticks would not have touched the rest of the state
+ */
+void Chip8Base::ElapseTimers(unsigned long ticks)
+{
+    delayTimer = ticks < delayTimer ? delayTimer - ticks : 0;
+    soundTimer = ticks < soundTimer ? soundTimer - ticks : 0;
+}
+
+/// @brief Reseed random number generator used by Cxkk so runs can be replayed
+void Chip8Base::Seed(unsigned int seed)
+{
+#ifdef CHIP8_FREESTANDING
+    randGen = Chip8Hooks::Seed(seed);
+#else
+    randGen.seed(seed);
+    randByte.reset();
+#endif
+}
+
+/// @brief Next byte from random number generator
+uint8_t Chip8Base::RandomByte()
+{
+#ifdef CHIP8_FREESTANDING
+    return Chip8Hooks::RandomByte(randGen);
+#else
+    return randByte(randGen);
+#endif
+}
+
+/// @brief Copy current machine state out of the interpreter. Only the
+///        memory the quirk profile can address is copied
+void Chip8Base::GetState(Chip8State &state) const
+{
+    GetStateWithoutMemory(state);
+    std::memcpy(state.memory, memory, memorySize);
+}
+
+/// @brief Copy everything but memory, for callers that only look at a part of it
+void Chip8Base::GetStateWithoutMemory(Chip8State &state) const
+{
+    std::memcpy(state.registers, registers, sizeof(registers));
+    state.index = index;
+    state.pc = pc;
+    std::memcpy(state.stack, stack, sizeof(stack));
+    state.sp = sp;
+    state.delayTimer = delayTimer;
+    state.soundTimer = soundTimer;
+    std::memcpy(state.video, video, sizeof(video));
+    state.hires = hires;
+    state.planes = planes;
+    std::memcpy(state.flags, flags, sizeof(flags));
+    std::memcpy(state.audioPattern, audioPattern, sizeof(audioPattern));
+    state.pitch = pitch;
+    state.randGen = randGen;
+}
+
+/// @brief Restore machine state taken with GetState on the same profile
+void Chip8Base::SetState(const Chip8State &state)
+{
+    std::memcpy(registers, state.registers, sizeof(registers));
+    std::memcpy(memory, state.memory, memorySize);
+    index = state.index;
+    pc = state.pc;
+    std::memcpy(stack, state.stack, sizeof(stack));
+    sp = state.sp;
+    delayTimer = state.delayTimer;
+    soundTimer = state.soundTimer;
+    std::memcpy(video, state.video, sizeof(video));
+    hires = state.hires;
+    planes = state.planes;
+    std::memcpy(flags, state.flags, sizeof(flags));
+    std::memcpy(audioPattern, state.audioPattern, sizeof(audioPattern));
+    pitch = state.pitch;
+    randGen = state.randGen;
+}
+
+/// @brief Copy ROM image into memory, caller keeps the image
+RomError Chip8Base::TryLoadROM(const uint8_t *data, size_t size)
+{
+    if (size > ProgramCapacity())
+    {
+        return RomError::TooLarge;
+    }
+    std::memcpy(&memory[START_ADDRESS], data, size);
+    return RomError::None;
+}
+
+/// @brief Largest ROM that fits into memory after the start address
+size_t Chip8Base::ProgramCapacity() const
+{
+    return memorySize - START_ADDRESS;
+}
+
+/// @brief Zero memory from start address on, so a shorter ROM leaves nothing of the last one
+void Chip8Base::ClearProgram()
+{
+    std::memset(&memory[START_ADDRESS], 0, memorySize - START_ADDRESS);
+}
+
+#ifndef CHIP8_FREESTANDING
+/// @brief Copy whole interpreter including dispatch tables, so a booted
+///        machine can be duplicated without constructing and loading again
+template <typename Quirks>
+std::unique_ptr<Chip8Base> Chip8<Quirks>::Clone() const
+{
+    return std::make_unique<Chip8>(*this);
 }
 
 /// @brief Load ROM instructions to the Chip8 memory
-void Chip8::LoadROM(const char *filename)
+void Chip8Base::LoadROM(const char *filename)
 {
     // Open file as binary and move pointer to the end
     std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (file.is_open())
     {
-        // Get size of file  allocate buffer to hold a file
+        // Get size of file, it is read straight into memory
         std::streampos size = file.tellg();
-        char *buffer = new char[size];
+        if (size > memorySize - START_ADDRESS)
+        {
+            throw "ROM is too large";
+        }
 
-        // go to the start and populate buffer
+        // go to the start and populate memory
         file.seekg(0, std::ios::beg);
-        file.read(buffer, size);
+        file.read(reinterpret_cast<char *>(&memory[START_ADDRESS]), size);
         file.close();
+    }
+    else
+    {
+        throw "File could not be opened";
+    }
+};
+
+void Chip8Base::LoadROM(const uint8_t *data, size_t size)
+{
+    if (TryLoadROM(data, size) != RomError::None)
+    {
+        throw "ROM is too large";
+    }
+};
+#endif
 
-        // Load content into Memory
-        for (long i = 0; i < size; ++i)
+/// @brief Clear Screen by setting all bytes of selected planes to 0
+template <typename Quirks>
+void Chip8<Quirks>::OP_00E0()
+{
+    for (unsigned int plane = 0; plane < VIDEO_PLANES; ++plane)
+    {
+        if (planes & (1u << plane))
         {
-            memory[START_ADDRESS + i] = buffer[i];
+            std::memset(video[plane], 0, sizeof(video[plane]));
         }
+    }
+};
 
-        delete[] buffer;
+/// @brief Scroll selected planes down by n rows
+template <typename Quirks>
+void Chip8<Quirks>::OP_00Cn()
+{
+    unsigned int rows = opcode & 0x000Fu;
+    unsigned int height = hires ? HIRES_VIDEO_HEIGHT : VIDEO_HEIGHT;
+    for (unsigned int plane = 0; plane < VIDEO_PLANES; ++plane)
+    {
+        if (planes & (1u << plane))
+        {
+            VideoRow *rowsOut = video[plane];
+            for (unsigned int y = height; y-- > rows;)
+            {
+                rowsOut[y] = rowsOut[y - rows];
+            }
+            std::memset(rowsOut, 0, sizeof(VideoRow) * rows);
+        }
     }
-    else
+};
+
+/// @brief Scroll selected planes up by n rows
+template <typename Quirks>
+void Chip8<Quirks>::OP_00Dn()
+{
+    unsigned int rows = opcode & 0x000Fu;
+    unsigned int height = hires ? HIRES_VIDEO_HEIGHT : VIDEO_HEIGHT;
+    for (unsigned int plane = 0; plane < VIDEO_PLANES; ++plane)
     {
-        throw "File could not be opened";
+        if (planes & (1u << plane))
+        {
+            VideoRow *rowsOut = video[plane];
+            for (unsigned int y = 0; y + rows < height; ++y)
+            {
+                rowsOut[y] = rowsOut[y + rows];
+            }
+            std::memset(rowsOut + height - rows, 0, sizeof(VideoRow) * rows);
+        }
     }
 };
 
-/// @brief Clear Screen by setting all bytes to 0
-void Chip8::OP_00E0()
+/// @brief Scroll selected planes right by 4 pixels
+template <typename Quirks>
+void Chip8<Quirks>::OP_00FB()
+{
+    VideoRow mask = WidthMask();
+    for (unsigned int plane = 0; plane < VIDEO_PLANES; ++plane)
+    {
+        if (planes & (1u << plane))
+        {
+            for (VideoRow &row : video[plane])
+            {
+                row = (row >> 4) & mask;
+            }
+        }
+    }
+};
+
+/// @brief Scroll selected planes left by 4 pixels
+template <typename Quirks>
+void Chip8<Quirks>::OP_00FC()
+{
+    for (unsigned int plane = 0; plane < VIDEO_PLANES; ++plane)
+    {
+        if (planes & (1u << plane))
+        {
+            for (VideoRow &row : video[plane])
+            {
+                row <<= 4;
+            }
+        }
+    }
+};
+
+/// @brief Exit interpreter by repeating this instruction forever
+template <typename Quirks>
+void Chip8<Quirks>::OP_00FD()
+{
+    pc -= 2;
+};
+
+/// @brief Switch to 64x32 lo-res mode and clear screen
+template <typename Quirks>
+void Chip8<Quirks>::OP_00FE()
+{
+    hires = false;
+    std::memset(video, 0, sizeof(video));
+};
+
+/// @brief Switch to 128x64 hi-res mode and clear screen
+template <typename Quirks>
+void Chip8<Quirks>::OP_00FF()
 {
+    hires = true;
     std::memset(video, 0, sizeof(video));
 };
 
 /// @brief Set random number between 0-255 to Vx
-void Chip8::OP_Cxkk()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Cxkk()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Byte = opcode & 0x00FFu;
-    registers[Vx] = (std::rand() * 255) & Byte;
+    registers[Vx] = RandomByte() & Byte;
 };
 
 /// @brief End soubroutine and return to PC in call stack
-void Chip8::OP_00EE()
+template <typename Quirks>
+void Chip8<Quirks>::OP_00EE()
 {
     --sp;
-    pc = stack[sp];
+    outOfRange += sp > STACK_MASK;
+    pc = stack[sp & STACK_MASK];
 };
 
 /// @brief Set PC to given address
-void Chip8::OP_1nnn()
+template <typename Quirks>
+void Chip8<Quirks>::OP_1nnn()
 {
     uint16_t address = (opcode & 0x0FFFu);
     pc = address;
 };
 
 /// @brief Set PC to given address as a subroutine call
-void Chip8::OP_2nnn()
+template <typename Quirks>
+void Chip8<Quirks>::OP_2nnn()
 {
     uint16_t address = (opcode & 0x0FFFu);
-    stack[sp] = pc;
+    outOfRange += sp > STACK_MASK;
+    stack[sp & STACK_MASK] = pc;
     ++sp;
     pc = address;
 };
 
 /// @brief If Vx and kk are equal skip next instruction
-void Chip8::OP_3xkk()
+template <typename Quirks>
+void Chip8<Quirks>::OP_3xkk()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t byte = (opcode & 0x00FFu);
     if (registers[Vx] == byte)
     {
-        pc += 2;
+        SkipNext();
     }
 };
 
 /// @brief If Vx and kk are not equal skip next instruction
-void Chip8::OP_4xkk()
+template <typename Quirks>
+void Chip8<Quirks>::OP_4xkk()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t byte = (opcode & 0x00FFu);
     if (registers[Vx] != byte)
     {
-        pc += 2;
+        SkipNext();
     }
 }
 
 /// @brief if Vx and Vy are equal skip next instruction
-void Chip8::OP_5xy0()
+template <typename Quirks>
+void Chip8<Quirks>::OP_5xy0()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
     if (registers[Vx] == registers[Vy])
     {
-        pc += 2;
+        SkipNext();
+    }
+};
+
+/// @brief Store registers Vx through Vy in memory starting at Index,
+///        in reverse order if x is larger than y
+template <typename Quirks>
+void Chip8<Quirks>::OP_5xy2()
+{
+    uint8_t Vx = (opcode & 0x0F00u) >> 8u;
+    uint8_t Vy = (opcode & 0x00F0u) >> 4u;
+    int step = Vx <= Vy ? 1 : -1;
+    unsigned int count = (Vx <= Vy ? Vy - Vx : Vx - Vy) + 1;
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Store(index + i) = registers[Vx + step * static_cast<int>(i)];
+    }
+};
+
+/// @brief Read registers Vx through Vy from memory starting at Index,
+///        in reverse order if x is larger than y
+template <typename Quirks>
+void Chip8<Quirks>::OP_5xy3()
+{
+    uint8_t Vx = (opcode & 0x0F00u) >> 8u;
+    uint8_t Vy = (opcode & 0x00F0u) >> 4u;
+    int step = Vx <= Vy ? 1 : -1;
+    unsigned int count = (Vx <= Vy ? Vy - Vx : Vx - Vy) + 1;
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        registers[Vx + step * static_cast<int>(i)] = Load(index + i);
     }
 };
 
 /// @brief set Vx to byte
-void Chip8::OP_6xkk()
+template <typename Quirks>
+void Chip8<Quirks>::OP_6xkk()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t byte = (opcode & 0x00FFu);
@@ -230,7 +796,8 @@ void Chip8::OP_6xkk()
 };
 
 /// @brief Add byte to Vx
-void Chip8::OP_7xkk()
+template <typename Quirks>
+void Chip8<Quirks>::OP_7xkk()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t byte = (opcode & 0x00FFu);
@@ -238,7 +805,8 @@ void Chip8::OP_7xkk()
 };
 
 /// @brief Set Vx to Vy
-void Chip8::OP_8xy0()
+template <typename Quirks>
+void Chip8<Quirks>::OP_8xy0()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
@@ -246,35 +814,54 @@ void Chip8::OP_8xy0()
 };
 
 /// @brief Set Vx to Vx OR Vy
-void Chip8::OP_8xy1()
+template <typename Quirks>
+void Chip8<Quirks>::OP_8xy1()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
     registers[Vx] |= registers[Vy];
+    if constexpr (Quirks::logicResetsVF)
+    {
+        registers[0xF] = 0;
+    }
 };
 
 /// @brief Set Vx to Vx AND Vy
-void Chip8::OP_8xy2()
+template <typename Quirks>
+void Chip8<Quirks>::OP_8xy2()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
     registers[Vx] &= registers[Vy];
+    if constexpr (Quirks::logicResetsVF)
+    {
+        registers[0xF] = 0;
+    }
 };
 
 /// @brief Set Vx to Vx XOR Vy
-void Chip8::OP_8xy3()
+template <typename Quirks>
+void Chip8<Quirks>::OP_8xy3()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
     registers[Vx] ^= registers[Vy];
+    if constexpr (Quirks::logicResetsVF)
+    {
+        registers[0xF] = 0;
+    }
 };
 
 /// @brief Add Vy to Vx and if sum overflows set VF = 1
-void Chip8::OP_8xy4()
+template <typename Quirks>
+void Chip8<Quirks>::OP_8xy4()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
     uint16_t sum = registers[Vx] + registers[Vy];
+    registers[Vx] = sum & 0xFFu;
+
+    // Flag is written last so it wins when Vx is VF
     if (sum > 255U)
     {
         registers[0xF] = 1;
@@ -283,18 +870,19 @@ void Chip8::OP_8xy4()
     {
         registers[0xF] = 0;
     }
-
-    registers[Vx] = sum & 0xFFu;
 };
 
 /// @brief Subtract Vy from Vx and if Vx is bigger than Vy set
 ///        VF to 1 else to 0
-void Chip8::OP_8xy5()
+template <typename Quirks>
+void Chip8<Quirks>::OP_8xy5()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
+    bool notBorrow = registers[Vx] > registers[Vy];
+    registers[Vx] -= registers[Vy];
 
-    if (registers[Vx] > registers[Vy])
+    if (notBorrow)
     {
         registers[0xF] = 1;
     }
@@ -302,27 +890,35 @@ void Chip8::OP_8xy5()
     {
         registers[0xF] = 0;
     }
-    registers[Vx] -= registers[Vy];
 };
 
 /// @brief Divide Vx by two and if least significant bit of Vx is 1,
-///        then VF is set to 1 else 0
-void Chip8::OP_8xy6()
+///        then VF is set to 1 else 0. Some profiles shift Vy into Vx
+template <typename Quirks>
+void Chip8<Quirks>::OP_8xy6()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
-    registers[0xF] = (registers[Vx] & 0x1u);
+    if constexpr (Quirks::shiftReadsVy)
+    {
+        registers[Vx] = registers[(opcode & 0x00F0u) >> 4u];
+    }
+    uint8_t flag = (registers[Vx] & 0x1u);
     // we divide by bitwise operatios as normal division would transform value to int
     registers[Vx] >>= 1;
+    registers[0xF] = flag;
 };
 
 /// @brief If Vy > Vx then VF = 1 and subtract Vx from Vy
 ///        and set that on Vx
-void Chip8::OP_8xy7()
+template <typename Quirks>
+void Chip8<Quirks>::OP_8xy7()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
+    bool notBorrow = registers[Vy] > registers[Vx];
+    registers[Vx] = registers[Vy] - registers[Vx];
 
-    if (registers[Vy] > registers[Vx])
+    if (notBorrow)
     {
         registers[0xF] = 1;
     }
@@ -330,157 +926,224 @@ void Chip8::OP_8xy7()
     {
         registers[0xF] = 0;
     }
-    registers[Vx] = registers[Vy] - registers[Vx];
 };
 
 /// @brief If most significant Bit Vx is 1 then VF = 1 else VF = 0
-///        then multiply Vx by two
-void Chip8::OP_8xyE()
+///        then multiply Vx by two. Some profiles shift Vy into Vx
+template <typename Quirks>
+void Chip8<Quirks>::OP_8xyE()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
-    registers[0xF] = (registers[Vx] & 0x80u) >> 7u;
+    if constexpr (Quirks::shiftReadsVy)
+    {
+        registers[Vx] = registers[(opcode & 0x00F0u) >> 4u];
+    }
+    uint8_t flag = (registers[Vx] & 0x80u) >> 7u;
     registers[Vx] <<= 1;
+    registers[0xF] = flag;
 };
 
 /// @brief Skip next instructions if Vx != Vy
-void Chip8::OP_9xy0()
+template <typename Quirks>
+void Chip8<Quirks>::OP_9xy0()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
 
     if (registers[Vx] != registers[Vy])
     {
-        pc += 2;
+        SkipNext();
     }
 };
 
 /// @brief Set Index to address
-void Chip8::OP_Annn()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Annn()
 {
     uint16_t address = (opcode & 0x0FFFu);
     index = address;
 };
 
-/// @brief Jump to specific address + V0
-void Chip8::OP_Bnnn()
+/// @brief Jump to specific address + V0, or to xnn + Vx on SUPER-CHIP
+template <typename Quirks>
+void Chip8<Quirks>::OP_Bnnn()
 {
     uint16_t address = (opcode & 0x0FFFu);
-    pc = address + registers[0];
+    if constexpr (Quirks::jumpUsesVx)
+    {
+        pc = address + registers[(opcode & 0x0F00u) >> 8u];
+    }
+    else
+    {
+        pc = address + registers[0];
+    }
 };
 
 /** @brief Display n-byte sprite read starting from Index register
  *         each sprite has one byte width. We then XOR the screen
  *         to check if there is a pixel already in there. If any
  *         sprite width or height is to long it wraps itself from
- *         opposite site
+ *         opposite site, or is clipped when the profile says so.
+ *         On SUPER-CHIP Dxy0 draws 16x16 sprite, on XO-CHIP every
+ *         selected plane takes its own sprite data from Index onwards.
+ *         Each sprite row becomes one shift and XOR of a whole video row
  */
-void Chip8::OP_Dxyn()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Dxyn()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t Vy = (opcode & 0x00F0u) >> 4u;
     uint8_t height = (opcode & 0x000Fu);
 
-    uint8_t xPos = registers[Vx] % VIDEO_WIDTH;
-    uint8_t yPos = registers[Vy] % VIDEO_HEIGHT;
+    unsigned int screenWidth = hires ? HIRES_VIDEO_WIDTH : VIDEO_WIDTH;
+    unsigned int screenHeight = hires ? HIRES_VIDEO_HEIGHT : VIDEO_HEIGHT;
+    unsigned int xPos = registers[Vx] % screenWidth;
+    unsigned int yPos = registers[Vy] % screenHeight;
 
+    unsigned int spriteWidth = 8;
+    if constexpr (Quirks::superChip)
+    {
+        if (height == 0)
+        {
+            spriteWidth = 16;
+            height = 16;
+        }
+    }
+
+    VideoRow mask = WidthMask();
+    uint16_t address = index;
     registers[0xF] = 0;
 
-    // Read Sprite Bytes
-    for (unsigned int row = 0; row < height; ++row)
+    for (unsigned int plane = 0; plane < VIDEO_PLANES; ++plane)
     {
-        uint8_t spriteByte = memory[index + row];
-        for (unsigned int column = 0; column < 8; ++column)
+        if (!(planes & (1u << plane)))
         {
-            // Read each Byte Pixel and get address of pixel that is already displayed
-            uint8_t spritePixel = spriteByte & (0x80u >> column);
-            uint32_t *screenPixel = &video[(xPos + column) + (yPos + row) * VIDEO_WIDTH];
+            continue;
+        }
 
-            // This works because pointer with zero value is converted to false
-            // check if we are drawing anything with sprite pixel
-            if (spritePixel)
+        // Read Sprite Bytes
+        for (unsigned int row = 0; row < height; ++row)
+        {
+            uint16_t spriteBits = Load(address++);
+            if (spriteWidth == 16)
             {
-                // Collision detection
-                if (*screenPixel == 0xFFFFFFFF)
+                spriteBits = (spriteBits << 8u) | Load(address++);
+            }
+
+            unsigned int y = yPos + row;
+            if (y >= screenHeight)
+            {
+                if constexpr (!Quirks::spritesWrap)
+                {
+                    continue;
+                }
+                y -= screenHeight;
+            }
+
+            // Sprite aligned to the left edge, then moved into place. Pixels
+            // pushed past the right edge are masked off or wrapped around
+            VideoRow sprite = static_cast<VideoRow>(spriteBits) << (HIRES_VIDEO_WIDTH - spriteWidth);
+            VideoRow pixels = (sprite >> xPos) & mask;
+            if constexpr (Quirks::spritesWrap)
+            {
+                if (xPos > 0)
                 {
-                    registers[0xF] = 1;
+                    pixels |= sprite << (screenWidth - xPos);
                 }
-                *screenPixel ^= 0xFFFFFFFF;
             }
+
+            // Collision detection
+            VideoRow &screenRow = video[plane][y];
+            if (screenRow & pixels)
+            {
+                registers[0xF] = 1;
+            }
+            screenRow ^= pixels;
         }
     }
 };
 
 /// @brief Skip instruction if key with value of Vx was pressed
-void Chip8::OP_Ex9E()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Ex9E()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t key = registers[Vx];
+    outOfRange += key > KEYPAD_MASK;
 
-    if (keypad[key])
+    if (keypad[key & KEYPAD_MASK])
     {
-        pc += 2;
+        SkipNext();
     }
 };
 
 /// @brief Skip instruction if key with value of Vx was not pressed
-void Chip8::OP_ExA1()
+template <typename Quirks>
+void Chip8<Quirks>::OP_ExA1()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t key = registers[Vx];
+    outOfRange += key > KEYPAD_MASK;
 
-    if (!keypad[key])
+    if (!keypad[key & KEYPAD_MASK])
     {
-        pc += 2;
+        SkipNext();
     }
 };
 
 /// @brief Set Vx to delay timer value
-void Chip8::OP_Fx07()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx07()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     registers[Vx] = delayTimer;
 };
 
 /// @brief Wait for key press and then store the value in Vx
-void Chip8::OP_Fx0A()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx0A()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
-    for (uint8_t i = 0; i < KEYPAD_SIZE + 1; ++i)
+    for (uint8_t i = 0; i < KEYPAD_SIZE; ++i)
     {
-        if (i == 16)
-        {
-            pc -= 2;
-        }
         if (keypad[i])
         {
             registers[Vx] = i;
+            return;
         }
     }
+
+    // No key pressed so repeat this instruction
+    pc -= 2;
 };
 
 /// @brief Set delay timer to Vx
-void Chip8::OP_Fx15()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx15()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     delayTimer = registers[Vx];
 };
 
 /// @brief Set sound timer to Vx
-void Chip8::OP_Fx18()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx18()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     soundTimer = registers[Vx];
 };
 
 /// @brief Set Index to Index + Vx
-void Chip8::OP_Fx1E()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx1E()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     index += registers[Vx];
 };
 
 /// @brief Set Index to location of sprite for digit Vx
-void Chip8::OP_Fx29()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx29()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint16_t address = FONSTSET_START_ADDRESS + (5 * registers[Vx]);
@@ -488,53 +1151,143 @@ void Chip8::OP_Fx29()
 };
 
 /// @brief Place hundreds digit in Index, tens in Index + 1 and ones in Index + 2
-void Chip8::OP_Fx33()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx33()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
     uint8_t value = registers[Vx];
 
-    memory[index + 2] = value % 10;
+    Store(index + 2) = value % 10;
     value /= 10;
 
-    memory[index + 1] = value % 10;
+    Store(index + 1) = value % 10;
     value /= 10;
 
-    memory[index] = value % 10;
+    Store(index) = value % 10;
+};
+
+/// @brief Set Index to location of big SUPER-CHIP sprite for digit Vx
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx30()
+{
+    uint8_t Vx = (opcode & 0x0F00u) >> 8u;
+    index = BIG_FONTSET_START_ADDRESS + (10 * (registers[Vx] & 0xFu));
+};
+
+/// @brief Store registers V0 through Vx in persistent flags
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx75()
+{
+    uint8_t Vx = (opcode & 0x0F00u) >> 8u;
+    std::memcpy(flags, registers, Vx + 1);
+};
+
+/// @brief Read registers V0 through Vx from persistent flags
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx85()
+{
+    uint8_t Vx = (opcode & 0x0F00u) >> 8u;
+    std::memcpy(registers, flags, Vx + 1);
+};
+
+/// @brief Set Index to 16 bit address stored in following word
+template <typename Quirks>
+void Chip8<Quirks>::OP_F000()
+{
+    index = (memory[Address(pc)] << 8u) | memory[Address(pc + 1)];
+    pc += 2;
+};
+
+/// @brief Select bitplanes n used by drawing, clearing and scrolling
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fn01()
+{
+    planes = (opcode & 0x0F00u) >> 8u & 0x3u;
+};
+
+/// @brief Load 16 byte audio pattern from Index
+template <typename Quirks>
+void Chip8<Quirks>::OP_F002()
+{
+    for (unsigned int i = 0; i < AUDIO_PATTERN_SIZE; ++i)
+    {
+        audioPattern[i] = Load(index + i);
+    }
+};
+
+/// @brief Set audio pattern playback pitch to Vx
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx3A()
+{
+    uint8_t Vx = (opcode & 0x0F00u) >> 8u;
+    pitch = registers[Vx];
 };
 
 /// @brief Store registers throught V0 to Vx in memory starting at Index
-void Chip8::OP_Fx55()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx55()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
 
     for (uint8_t i = 0; i <= Vx; ++i)
     {
-        memory[index + i] = registers[i];
+        Store(index + i) = registers[i];
+    }
+
+    if constexpr (Quirks::loadStoreIncrementsIndex)
+    {
+        index += Vx + 1;
     }
 };
 
 /// @brief Read registers throught V0 to Vx in memory starting at Index into registers
-void Chip8::OP_Fx65()
+template <typename Quirks>
+void Chip8<Quirks>::OP_Fx65()
 {
     uint8_t Vx = (opcode & 0x0F00u) >> 8u;
 
     for (uint8_t i = 0; i <= Vx; ++i)
     {
-        registers[i] = memory[index + i];
+        registers[i] = Load(index + i);
+    }
+
+    if constexpr (Quirks::loadStoreIncrementsIndex)
+    {
+        index += Vx + 1;
     }
 };
 
 /// @brief Execute Current instruction in memory
-void Chip8::Tick()
+template <typename Quirks>
+void Chip8<Quirks>::Tick()
 {
-    opcode = (memory[pc] << 8u) | memory[pc + 1];
+    // Debugger may hold machine and watches registers across instruction
+    uint8_t before[REGISTER_SIZE];
+    if constexpr (Quirks::debug)
+    {
+        if (debugger)
+        {
+            if (!debugger->BeforeInstruction(Wrap(pc)))
+            {
+                return;
+            }
+            std::memcpy(before, registers, sizeof(before));
+        }
+    }
+
+    opcode = (memory[Address(pc)] << 8u) | memory[Address(pc + 1)];
 
+#if defined(CHIP8_TRACE) && defined(CHIP8_FREESTANDING)
+    Chip8Hooks::Trace(pc, opcode);
+#elif defined(CHIP8_TRACE)
     std::cout << "DEBUG: ----------PARSE----------" << std::endl
               << "Current opcode: " << std::hex << opcode << std::endl
               << "Current program counter: " << pc << std::endl
               << std::endl;
+#endif
 
     pc += 2;
+    ++instructions;
 
     ((*this).*(table[(opcode & 0xF000) >> 12u]))();
 
@@ -546,4 +1299,56 @@ void Chip8::Tick()
     {
         --soundTimer;
     }
-};
\ No newline at end of file
+
+    if constexpr (Quirks::debug)
+    {
+        if (debugger)
+        {
+            debugger->AfterInstruction(Wrap(pc), before, registers);
+        }
+    }
+};
+
+template class Chip8<QuirksChip8>;
+template class Chip8<QuirksCosmacVIP>;
+template class Chip8<QuirksSuperChip>;
+template class Chip8<QuirksXOChip>;
+
+#ifndef CHIP8_FREESTANDING
+template class Chip8<Debugged<QuirksChip8>>;
+template class Chip8<Debugged<QuirksCosmacVIP>>;
+template class Chip8<Debugged<QuirksSuperChip>>;
+template class Chip8<Debugged<QuirksXOChip>>;
+
+/// @brief Create interpreter specialized for given quirk profile
+std::unique_ptr<Chip8Base> CreateChip8(QuirkProfile profile)
+{
+    switch (profile)
+    {
+    case QuirkProfile::CosmacVIP:
+        return std::make_unique<Chip8<QuirksCosmacVIP>>();
+    case QuirkProfile::SuperChip:
+        return std::make_unique<Chip8<QuirksSuperChip>>();
+    case QuirkProfile::XOChip:
+        return std::make_unique<Chip8<QuirksXOChip>>();
+    default:
+        return std::make_unique<Chip8<QuirksChip8>>();
+    }
+};
+
+/// @brief Create interpreter for given quirk profile that calls debugger hooks once attached
+std::unique_ptr<Chip8Base> CreateDebugChip8(QuirkProfile profile)
+{
+    switch (profile)
+    {
+    case QuirkProfile::CosmacVIP:
+        return std::make_unique<Chip8<Debugged<QuirksCosmacVIP>>>();
+    case QuirkProfile::SuperChip:
+        return std::make_unique<Chip8<Debugged<QuirksSuperChip>>>();
+    case QuirkProfile::XOChip:
+        return std::make_unique<Chip8<Debugged<QuirksXOChip>>>();
+    default:
+        return std::make_unique<Chip8<Debugged<QuirksChip8>>>();
+    }
+};
+#endif
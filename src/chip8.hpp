@@ -1,35 +1,183 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
+#include "quirks.hpp"
+
+/** @brief CHIP8_FREESTANDING builds the core without iostream, exceptions
+ *         or heap: ROMs only come from memory the caller owns, errors are
+ *         returned, machines are plain objects the caller places, and random
+ *         numbers and tracing come from the hooks header CHIP8_HOOKS.
+ */
+#ifdef CHIP8_FREESTANDING
+#ifndef CHIP8_HOOKS
+#define CHIP8_HOOKS "hooks.hpp"
+#endif
+#include CHIP8_HOOKS
+typedef Chip8Hooks::RandomState Chip8Random;
+#else
+#include <memory>
+#include <random>
+typedef std::default_random_engine Chip8Random;
+#endif
 
 const unsigned int REGISTER_SIZE = 16;
-const unsigned int MEMORY_SIZE = 4096;
+// Largest memory of any profile, machines only hold what their profile addresses
+const unsigned int MEMORY_SIZE = 0x10000;
 const unsigned int KEYPAD_SIZE = 16;
 const unsigned int VIDEO_WIDTH = 64;
 const unsigned int VIDEO_HEIGHT = 32;
-const unsigned int VIDEO_SIZE = VIDEO_WIDTH * VIDEO_HEIGHT;
+const unsigned int HIRES_VIDEO_WIDTH = 128;
+const unsigned int HIRES_VIDEO_HEIGHT = 64;
+const unsigned int HIRES_VIDEO_SIZE = HIRES_VIDEO_WIDTH * HIRES_VIDEO_HEIGHT;
+const unsigned int VIDEO_PLANES = 2;
 const unsigned int STACK_SIZE = 16;
+const unsigned int FLAGS_SIZE = 16;
+const unsigned int AUDIO_PATTERN_SIZE = 16;
+
+/** @brief One framebuffer row with pixel x stored in bit 127 - x. Lo-res
+ *         only uses the upper 64 bits of the first 32 rows, so sprites and
+ *         scrolls are whole row shifts in both resolutions.
+ */
+typedef unsigned __int128 VideoRow;
 
-class Chip8
+/** @brief Copy of the whole observable machine state, of any profile. Memory
+ *         comes last so a copy can stop after the bytes its profile uses
+ */
+struct Chip8State
 {
-private:
     uint8_t registers[REGISTER_SIZE]{};
+    uint16_t index{};
+    uint16_t pc{};
+    uint16_t stack[STACK_SIZE]{};
+    uint8_t sp{};
+    uint8_t delayTimer{};
+    uint8_t soundTimer{};
+    VideoRow video[VIDEO_PLANES][HIRES_VIDEO_HEIGHT]{};
+    bool hires{};
+    uint8_t planes{};
+    uint8_t flags[FLAGS_SIZE]{};
+    uint8_t audioPattern[AUDIO_PATTERN_SIZE]{};
+    uint8_t pitch{};
+    Chip8Random randGen;
     uint8_t memory[MEMORY_SIZE]{};
-    uint16_t index;
+};
+
+/// @brief Why a ROM could not be loaded
+enum class RomError
+{
+    None,
+    TooLarge
+};
+
+class Debugger;
+
+/// @brief Machine state and everything that does not depend on quirks
+class Chip8Base
+{
+protected:
+    uint8_t registers[REGISTER_SIZE]{};
+    // Points into interpreter, which holds as much as its profile addresses
+    uint8_t *memory;
+    uint16_t index{};
     uint16_t pc;
     uint16_t stack[STACK_SIZE]{};
     uint8_t sp{};
-    uint8_t delayTimer;
-    uint8_t soundTimer;
+    uint8_t delayTimer{};
+    uint8_t soundTimer{};
     uint16_t opcode;
+    uint32_t outOfRange{};
+    uint32_t unknownOpcodes{};
+    uint32_t instructions{};
+    const unsigned int memorySize;
+
+    // SUPER-CHIP and XO-CHIP state
+    bool hires{};
+    uint8_t planes = 0x1;
+    uint8_t flags[FLAGS_SIZE]{};
+    uint8_t audioPattern[AUDIO_PATTERN_SIZE]{};
+    uint8_t pitch{};
+
+    Chip8Random randGen;
+#ifndef CHIP8_FREESTANDING
+    std::uniform_int_distribution<unsigned int> randByte{0, 255U};
+#endif
+    uint8_t RandomByte();
+
+    // Only consulted by interpreters built with Debugged quirks
+    Debugger *debugger{};
+
+public:
+    Chip8Base(unsigned int memorySize, uint8_t *memory);
+#ifdef CHIP8_FREESTANDING
+    // Nothing is deleted without a heap, so no deleting destructor needs operator delete
+    ~Chip8Base();
+#else
+    virtual ~Chip8Base();
+#endif
+    uint8_t keypad[KEYPAD_SIZE]{};
+    VideoRow video[VIDEO_PLANES][HIRES_VIDEO_HEIGHT]{};
+    void RenderVideo(uint32_t *pixels) const;
+    void Reset();
+    RomError TryLoadROM(const uint8_t *data, size_t size);
+    size_t ProgramCapacity() const;
+    void ClearProgram();
+#ifndef CHIP8_FREESTANDING
+    void LoadROM(const char *filename);
+    void LoadROM(const uint8_t *data, size_t size);
+#endif
+    void Seed(unsigned int seed);
+    void GetState(Chip8State &state) const;
+    void GetStateWithoutMemory(Chip8State &state) const;
+    void SetState(const Chip8State &state);
+#ifndef CHIP8_FREESTANDING
+    virtual std::unique_ptr<Chip8Base> Clone() const = 0;
+#endif
+    uint32_t OutOfRangeAccesses() const;
+    uint32_t UnknownOpcodes() const;
+    uint32_t Instructions() const;
+    const uint8_t *Registers() const;
+    const uint8_t *Memory() const;
+    unsigned int MemorySize() const;
+    uint16_t Index() const;
+    uint16_t PC() const;
+    uint8_t DelayTimer() const;
+    uint8_t SoundTimer() const;
+    bool Hires() const;
+    void Attach(Debugger *debugger);
+    uint16_t OpcodeAt(unsigned int address) const;
+    void ElapseTimers(unsigned long ticks);
+    virtual void Tick() = 0;
+};
+
+/// @brief Interpreter specialized for one quirk profile from quirks.hpp
+template <typename Quirks = QuirksChip8>
+class Chip8 : public Chip8Base
+{
+private:
+    uint16_t Wrap(unsigned int address) const;
+    uint16_t Address(unsigned int address);
+    uint8_t Load(unsigned int address);
+    uint8_t &Store(unsigned int address);
+    void SkipNext();
+    VideoRow WidthMask() const;
 
     // OPCODES
     void OP_00E0();
     void OP_00EE();
+    void OP_00Cn();
+    void OP_00Dn();
+    void OP_00FB();
+    void OP_00FC();
+    void OP_00FD();
+    void OP_00FE();
+    void OP_00FF();
     void OP_1nnn();
     void OP_2nnn();
     void OP_3xkk();
     void OP_4xkk();
     void OP_5xy0();
+    void OP_5xy2();
+    void OP_5xy3();
     void OP_6xkk();
     void OP_7xkk();
     void OP_8xy0();
@@ -57,25 +205,52 @@ private:
     void OP_Fx33();
     void OP_Fx55();
     void OP_Fx65();
+    void OP_Fx30();
+    void OP_Fx75();
+    void OP_Fx85();
+    void OP_F000();
+    void OP_Fn01();
+    void OP_F002();
+    void OP_Fx3A();
     void OP_NULL();
 
     // FUNCTION TABLES
     void Table0();
+    void Table5();
     void Table8();
     void TableE();
     void TableF();
 
     typedef void (Chip8::*Chip8Func)();
     Chip8Func table[0xF + 1];
-    Chip8Func table0[0xE + 1];
-    Chip8Func table8[0xE + 1];
-    Chip8Func tableE[0xE + 1];
-    Chip8Func tableF[0x65 + 1];
+    Chip8Func table0[0xFF + 1];
+    Chip8Func table5[0xF + 1];
+    Chip8Func table8[0xF + 1];
+    Chip8Func tableE[0xF + 1];
+    Chip8Func tableF[0xFF + 1];
+
+    uint8_t storage[Quirks::memorySize];
 
 public:
     Chip8();
-    uint8_t keypad[KEYPAD_SIZE]{};
-    uint32_t video[VIDEO_SIZE]{};
-    void LoadROM(const char *filename);
-    void Tick();
-};
\ No newline at end of file
+    Chip8(const Chip8 &other);
+#ifndef CHIP8_FREESTANDING
+    std::unique_ptr<Chip8Base> Clone() const override;
+#endif
+    void Tick() override;
+};
+
+extern template class Chip8<QuirksChip8>;
+extern template class Chip8<QuirksCosmacVIP>;
+extern template class Chip8<QuirksSuperChip>;
+extern template class Chip8<QuirksXOChip>;
+
+#ifndef CHIP8_FREESTANDING
+extern template class Chip8<Debugged<QuirksChip8>>;
+extern template class Chip8<Debugged<QuirksCosmacVIP>>;
+extern template class Chip8<Debugged<QuirksSuperChip>>;
+extern template class Chip8<Debugged<QuirksXOChip>>;
+
+std::unique_ptr<Chip8Base> CreateChip8(QuirkProfile profile);
+std::unique_ptr<Chip8Base> CreateDebugChip8(QuirkProfile profile);
+#endif
\ No newline at end of file
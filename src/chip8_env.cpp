@@ -0,0 +1,303 @@
+#include "chip8_env.h"
+#include "chip8.hpp"
+#include <cstring>
+#include <new>
+
+struct Chip8Env
+{
+    std::unique_ptr<Chip8Base> chip8;
+    std::unique_ptr<Chip8State> initial;
+    QuirkProfile profile;
+    uint32_t seed;
+    bool extended;
+    int observationFormat;
+    uint32_t ticksPerFrame = CHIP8_ENV_DEFAULT_TICKS_PER_FRAME;
+    uint32_t maxFrames = 0;
+    uint32_t frame = 0;
+    bool done = false;
+    Chip8EnvRewardHook rewardHook = nullptr;
+    void *rewardUser = nullptr;
+};
+
+// Byte of pixels spread to one byte per pixel and to two bits per pixel
+struct ObservationTables
+{
+    uint8_t spread[256][8];
+    uint16_t doubled[256];
+
+    ObservationTables()
+    {
+        for (unsigned int byte = 0; byte < 256; ++byte)
+        {
+            doubled[byte] = 0;
+            for (unsigned int bit = 0; bit < 8; ++bit)
+            {
+                unsigned int pixel = (byte >> (7 - bit)) & 0x1u;
+                spread[byte][bit] = pixel;
+                doubled[byte] |= (pixel * 0x3u) << (14 - 2 * bit);
+            }
+        }
+    }
+};
+
+const ObservationTables observationTables;
+
+/// @brief Byte b of video row, byte 0 holding the leftmost 8 pixels
+static uint8_t RowByte(VideoRow row, unsigned int b)
+{
+    return static_cast<uint8_t>(row >> (HIRES_VIDEO_WIDTH - 8 - 8 * b));
+}
+
+static unsigned int ObservationWidth(const Chip8Env &env)
+{
+    return env.extended ? HIRES_VIDEO_WIDTH : VIDEO_WIDTH;
+}
+
+static unsigned int ObservationHeight(const Chip8Env &env)
+{
+    return env.extended ? HIRES_VIDEO_HEIGHT : VIDEO_HEIGHT;
+}
+
+/** @brief Write framebuffer into observation a byte of pixels at a time.
+ *         When the observation is hi-res and the machine is in lo-res
+ *         each source byte is doubled horizontally and each row twice
+ */
+static void WriteObservation(const Chip8Env &env, uint8_t *out)
+{
+    const Chip8Base &chip8 = *env.chip8;
+    unsigned int width = ObservationWidth(env);
+    unsigned int height = ObservationHeight(env);
+    unsigned int shift = env.extended && !chip8.Hires() ? 1 : 0;
+    unsigned int sourceBytes = (width >> shift) / 8;
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        VideoRow first = chip8.video[0][y >> shift];
+        VideoRow second = chip8.video[1][y >> shift];
+
+        for (unsigned int b = 0; b < sourceBytes; ++b)
+        {
+            uint8_t firstByte = RowByte(first, b);
+            uint8_t secondByte = RowByte(second, b);
+
+            if (env.observationFormat == CHIP8_ENV_OBSERVATION_1BIT)
+            {
+                uint8_t lit = firstByte | secondByte;
+                if (shift)
+                {
+                    uint16_t pixels = observationTables.doubled[lit];
+                    *out++ = pixels >> 8u;
+                    *out++ = pixels & 0xFFu;
+                }
+                else
+                {
+                    *out++ = lit;
+                }
+            }
+            else
+            {
+                const uint8_t *firstPixels = observationTables.spread[firstByte];
+                const uint8_t *secondPixels = observationTables.spread[secondByte];
+                for (unsigned int bit = 0; bit < 8; ++bit)
+                {
+                    uint8_t color = firstPixels[bit] | (secondPixels[bit] << 1);
+                    *out++ = color;
+                    if (shift)
+                    {
+                        *out++ = color;
+                    }
+                }
+            }
+        }
+    }
+}
+
+uint32_t chip8_env_abi_version(void)
+{
+    return CHIP8_ENV_ABI_VERSION;
+}
+
+Chip8Env *chip8_env_create(int profile, int observationFormat, uint32_t seed)
+{
+    if (profile < CHIP8_ENV_PROFILE_CHIP8 || profile > CHIP8_ENV_PROFILE_XO_CHIP ||
+        (observationFormat != CHIP8_ENV_OBSERVATION_1BIT && observationFormat != CHIP8_ENV_OBSERVATION_8BIT))
+    {
+        return nullptr;
+    }
+
+    Chip8Env *env = new (std::nothrow) Chip8Env;
+    if (!env)
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        env->chip8 = CreateChip8(static_cast<QuirkProfile>(profile));
+        env->initial = std::make_unique<Chip8State>();
+    }
+    catch (...)
+    {
+        delete env;
+        return nullptr;
+    }
+
+    env->chip8->Seed(seed);
+    env->chip8->GetState(*env->initial);
+    env->profile = static_cast<QuirkProfile>(profile);
+    env->seed = seed;
+    env->extended = profile == CHIP8_ENV_PROFILE_SUPER_CHIP || profile == CHIP8_ENV_PROFILE_XO_CHIP;
+    env->observationFormat = observationFormat;
+    return env;
+}
+
+void chip8_env_destroy(Chip8Env *env)
+{
+    delete env;
+}
+
+int chip8_env_reset(Chip8Env *env, const uint8_t *rom, size_t size, uint8_t *observation)
+{
+    if (!env)
+    {
+        return CHIP8_ENV_ERROR_ARGUMENT;
+    }
+
+    if (rom)
+    {
+        // New machine so nothing of the previous ROM remains in memory
+        try
+        {
+            std::unique_ptr<Chip8Base> chip8 = CreateChip8(env->profile);
+            chip8->Seed(env->seed);
+            chip8->LoadROM(rom, size);
+            env->chip8 = std::move(chip8);
+        }
+        catch (const char *)
+        {
+            return CHIP8_ENV_ERROR_ROM;
+        }
+        catch (...)
+        {
+            return CHIP8_ENV_ERROR_MEMORY;
+        }
+        env->chip8->GetState(*env->initial);
+    }
+    else
+    {
+        env->chip8->SetState(*env->initial);
+    }
+
+    std::memset(env->chip8->keypad, 0, sizeof(env->chip8->keypad));
+    env->frame = 0;
+    env->done = false;
+
+    if (observation)
+    {
+        WriteObservation(*env, observation);
+    }
+    return CHIP8_ENV_OK;
+}
+
+void chip8_env_set_reward_hook(Chip8Env *env, Chip8EnvRewardHook hook, void *user)
+{
+    if (!env)
+    {
+        return;
+    }
+    env->rewardHook = hook;
+    env->rewardUser = user;
+}
+
+void chip8_env_set_ticks_per_frame(Chip8Env *env, uint32_t ticks)
+{
+    if (!env)
+    {
+        return;
+    }
+    env->ticksPerFrame = ticks;
+}
+
+void chip8_env_set_max_frames(Chip8Env *env, uint32_t frames)
+{
+    if (!env)
+    {
+        return;
+    }
+    env->maxFrames = frames;
+}
+
+size_t chip8_env_observation_size(const Chip8Env *env)
+{
+    if (!env)
+    {
+        return 0;
+    }
+    size_t pixels = ObservationWidth(*env) * ObservationHeight(*env);
+    return env->observationFormat == CHIP8_ENV_OBSERVATION_1BIT ? pixels / 8 : pixels;
+}
+
+int chip8_env_observe(const Chip8Env *env, uint8_t *observation)
+{
+    if (!env || !observation)
+    {
+        return CHIP8_ENV_ERROR_ARGUMENT;
+    }
+    WriteObservation(*env, observation);
+    return CHIP8_ENV_OK;
+}
+
+Chip8EnvStepResult chip8_env_step(Chip8Env *env, uint16_t action, uint32_t frames, uint8_t *observation)
+{
+    if (!env)
+    {
+        return {0.0f, 1};
+    }
+
+    Chip8EnvStepResult result = {0.0f, env->done};
+    Chip8Base &chip8 = *env->chip8;
+
+    for (unsigned int key = 0; key < KEYPAD_SIZE; ++key)
+    {
+        chip8.keypad[key] = (action >> key) & 0x1u;
+    }
+
+    for (uint32_t frame = 0; frame < frames && !env->done; ++frame)
+    {
+        for (uint32_t tick = 0; tick < env->ticksPerFrame; ++tick)
+        {
+            chip8.Tick();
+        }
+        ++env->frame;
+
+        int done = 0;
+        if (env->rewardHook)
+        {
+            Chip8EnvView view = {chip8.Registers(), chip8.Memory(), chip8.MemorySize(), chip8.Index(), chip8.PC(),
+                                 chip8.DelayTimer(), chip8.SoundTimer(), env->frame};
+            result.reward += env->rewardHook(&view, &done, env->rewardUser);
+        }
+        env->done = done || (env->maxFrames && env->frame >= env->maxFrames);
+    }
+
+    result.done = env->done;
+    if (observation)
+    {
+        WriteObservation(*env, observation);
+    }
+    return result;
+}
+
+void chip8_env_step_many(Chip8Env *const *envs, size_t count, const uint16_t *actions, uint32_t frames,
+                         uint8_t *observations, size_t observationStride, Chip8EnvStepResult *results)
+{
+    if (!envs || !actions || !results)
+    {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint8_t *observation = observations ? observations + i * observationStride : nullptr;
+        results[i] = chip8_env_step(envs[i], actions[i], frames, observation);
+    }
+}
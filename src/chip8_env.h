@@ -0,0 +1,110 @@
+#ifndef CHIP8_ENV_H
+#define CHIP8_ENV_H
+
+/*
+ * Stable C interface for driving Chip8 from agent training code.
+ *
+ * An environment owns one interpreter. Steps hold a 16 bit key mask for a
+ * number of frames, call the reward hook after every frame and write the
+ * observation straight from the packed framebuffer into caller memory.
+ * Nothing here throws and only loading a new ROM allocates. Restarting an
+ * episode restores the state right after loading, including random seed.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Bump when the layout of any struct or meaning of any call changes */
+#define CHIP8_ENV_ABI_VERSION 2
+
+/* Quirk profiles, same order as QuirkProfile */
+#define CHIP8_ENV_PROFILE_CHIP8 0
+#define CHIP8_ENV_PROFILE_COSMAC_VIP 1
+#define CHIP8_ENV_PROFILE_SUPER_CHIP 2
+#define CHIP8_ENV_PROFILE_XO_CHIP 3
+
+/*
+ * Observation formats. Observations are 64x32 for CHIP-8 and COSMAC VIP
+ * and 128x64 for SUPER-CHIP and XO-CHIP, where lo-res pixels are doubled.
+ * 1 bit: rows of width / 8 bytes, leftmost pixel in the top bit, a pixel
+ *        is set if it is lit in any plane
+ * 8 bit: one byte per pixel holding plane bits, 0 to 3
+ */
+#define CHIP8_ENV_OBSERVATION_1BIT 0
+#define CHIP8_ENV_OBSERVATION_8BIT 1
+
+#define CHIP8_ENV_OK 0
+#define CHIP8_ENV_ERROR_ARGUMENT -1
+#define CHIP8_ENV_ERROR_ROM -2
+#define CHIP8_ENV_ERROR_MEMORY -3
+
+#define CHIP8_ENV_DEFAULT_TICKS_PER_FRAME 4
+
+typedef struct Chip8Env Chip8Env;
+
+/*
+ * Read only view of machine handed to reward hooks, valid during the call.
+ * memory holds memorySize bytes, 4 KB or 64 KB depending on profile.
+ */
+typedef struct Chip8EnvView
+{
+    const uint8_t *registers;
+    const uint8_t *memory;
+    uint32_t memorySize;
+    uint16_t index;
+    uint16_t pc;
+    uint8_t delayTimer;
+    uint8_t soundTimer;
+    uint32_t frame;
+} Chip8EnvView;
+
+/* Called after every frame. Returns reward and sets *done to end the episode */
+typedef float (*Chip8EnvRewardHook)(const Chip8EnvView *view, int *done, void *user);
+
+typedef struct Chip8EnvStepResult
+{
+    float reward;
+    int done;
+} Chip8EnvStepResult;
+
+uint32_t chip8_env_abi_version(void);
+
+Chip8Env *chip8_env_create(int profile, int observationFormat, uint32_t seed);
+void chip8_env_destroy(Chip8Env *env);
+
+/* Load ROM and start new episode. NULL rom restarts the last loaded ROM */
+int chip8_env_reset(Chip8Env *env, const uint8_t *rom, size_t size, uint8_t *observation);
+
+void chip8_env_set_reward_hook(Chip8Env *env, Chip8EnvRewardHook hook, void *user);
+void chip8_env_set_ticks_per_frame(Chip8Env *env, uint32_t ticks);
+/* Episode ends after this many frames, 0 never ends it */
+void chip8_env_set_max_frames(Chip8Env *env, uint32_t frames);
+
+size_t chip8_env_observation_size(const Chip8Env *env);
+int chip8_env_observe(const Chip8Env *env, uint8_t *observation);
+
+/*
+ * Every call below takes NULL env without touching anything: setters do
+ * nothing, observation size is 0 and steps return done.
+ */
+
+/* Hold action key mask for frames. observation may be NULL */
+Chip8EnvStepResult chip8_env_step(Chip8Env *env, uint16_t action, uint32_t frames, uint8_t *observation);
+
+/*
+ * Step count environments. Observation of environment i is written at
+ * observations + i * observationStride, observations may be NULL.
+ */
+void chip8_env_step_many(Chip8Env *const *envs, size_t count, const uint16_t *actions, uint32_t frames,
+                         uint8_t *observations, size_t observationStride, Chip8EnvStepResult *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
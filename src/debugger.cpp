@@ -0,0 +1,67 @@
+#include "debugger.hpp"
+#include <cstring>
+
+void Debugger::SetBreakpoint(uint16_t address, bool enabled)
+{
+    breakpoints[address] = enabled;
+}
+
+/// @brief Watch length bytes from address for reads, writes or both
+void Debugger::SetWatchpoint(uint16_t address, uint16_t length, uint8_t kind, bool enabled)
+{
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        uint8_t &watch = watchpoints[(address + i) % MEMORY_SIZE];
+        watch = enabled ? watch | kind : watch & ~kind;
+    }
+}
+
+/// @brief Stop after any instruction that changes register Vx
+void Debugger::SetRegisterWatch(uint8_t reg, bool enabled)
+{
+    uint16_t bit = 1u << (reg % REGISTER_SIZE);
+    registerWatch = enabled ? registerWatch | bit : registerWatch & ~bit;
+}
+
+/// @brief Drop every breakpoint and watchpoint
+void Debugger::Clear()
+{
+    std::memset(breakpoints, 0, sizeof(breakpoints));
+    std::memset(watchpoints, 0, sizeof(watchpoints));
+    registerWatch = 0;
+}
+
+void Debugger::Continue()
+{
+    stopped = false;
+    stepping = false;
+}
+
+/// @brief Run exactly one instruction and stop again
+void Debugger::Step()
+{
+    stopped = false;
+    stepping = true;
+}
+
+bool Debugger::Stopped() const
+{
+    return stopped;
+}
+
+StopReason Debugger::Reason() const
+{
+    return reason;
+}
+
+/// @brief Memory address of watchpoint that stopped machine
+uint16_t Debugger::StopAddress() const
+{
+    return stopAddress;
+}
+
+/// @brief Register whose watch stopped machine
+uint8_t Debugger::StopRegister() const
+{
+    return stopRegister;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include "chip8.hpp"
+
+const uint8_t WATCH_READ = 0x1;
+const uint8_t WATCH_WRITE = 0x2;
+
+enum class StopReason
+{
+    None,
+    Attach,
+    Interrupt,
+    Breakpoint,
+    Step,
+    WatchRead,
+    WatchWrite,
+    WatchRegister
+};
+
+/** @brief Breakpoints, watchpoints and run control for one machine. Only
+ *         interpreters built with Debugged quirks call its hooks, from
+ *         Tick around every instruction. A stopped machine does not run
+ *         or count its timers down until Continue or Step.
+ */
+class Debugger
+{
+private:
+    bool breakpoints[MEMORY_SIZE]{};
+    uint8_t watchpoints[MEMORY_SIZE]{};
+    uint16_t registerWatch{};
+    bool stopped{};
+    bool stepping{};
+    // pc stopped at, its breakpoint does not fire again when resuming
+    int resumePc = -1;
+    StopReason reason = StopReason::None;
+    uint16_t stopAddress{};
+    uint8_t stopRegister{};
+
+public:
+    void SetBreakpoint(uint16_t address, bool enabled);
+    void SetWatchpoint(uint16_t address, uint16_t length, uint8_t kind, bool enabled);
+    void SetRegisterWatch(uint8_t reg, bool enabled);
+    void Clear();
+
+    void Continue();
+    void Step();
+    void Stop(StopReason why);
+    bool Stopped() const;
+    StopReason Reason() const;
+    uint16_t StopAddress() const;
+    uint8_t StopRegister() const;
+
+    bool BeforeInstruction(uint16_t pc);
+    void MemoryAccess(uint16_t address, uint8_t kind);
+    void AfterInstruction(uint16_t pc, const uint8_t *before, const uint8_t *after);
+};
+
+// Hooks are called from the execution loop so they are defined here to be inlined
+
+inline void Debugger::Stop(StopReason why)
+{
+    if (!stopped)
+    {
+        stopped = true;
+        reason = why;
+        stepping = false;
+    }
+}
+
+/// @brief Called before fetching instruction at pc, false keeps machine where it is
+inline bool Debugger::BeforeInstruction(uint16_t pc)
+{
+    if (stopped)
+    {
+        return false;
+    }
+
+    bool resuming = resumePc == pc;
+    resumePc = -1;
+    if (breakpoints[pc] && !resuming)
+    {
+        Stop(StopReason::Breakpoint);
+        resumePc = pc;
+        return false;
+    }
+    return true;
+}
+
+/// @brief Called for every data read and write, the instruction still completes
+inline void Debugger::MemoryAccess(uint16_t address, uint8_t kind)
+{
+    if ((watchpoints[address] & kind) && !stopped)
+    {
+        Stop(kind == WATCH_WRITE ? StopReason::WatchWrite : StopReason::WatchRead);
+        stopAddress = address;
+    }
+}
+
+/// @brief Called after instruction with registers from before and after it
+inline void Debugger::AfterInstruction(uint16_t pc, const uint8_t *before, const uint8_t *after)
+{
+    for (uint8_t reg = 0; registerWatch && reg < REGISTER_SIZE; ++reg)
+    {
+        if ((registerWatch >> reg) & 0x1u && before[reg] != after[reg])
+        {
+            Stop(StopReason::WatchRegister);
+            stopRegister = reg;
+            break;
+        }
+    }
+
+    if (stepping)
+    {
+        Stop(StopReason::Step);
+    }
+    if (stopped)
+    {
+        resumePc = pc;
+    }
+}
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "chip8.hpp"
+
+#ifndef _WIN32
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+const unsigned int DEFAULT_STARTS = 200;
+
+// Clear screen, draw digit 8 at (8, 8) and stay there
+const uint8_t FOOTPRINT_ROM[] = {
+    0x00, 0xE0,
+    0x60, 0x08,
+    0xF0, 0x29,
+    0xD0, 0x05,
+    0x12, 0x08};
+
+// Whole machine is fixed size and placed by the program, nothing is allocated
+static Chip8<QuirksChip8> machine;
+
+static long long Now()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/** @brief Size and startup benchmark of the core, built once freestanding
+ *         and once hosted by make footprint. Every start spawns this
+ *         program again, which loads the ROM from the array above, runs
+ *         one instruction and reports how long after the spawn that was.
+ *
+ *  usage: footprint [STARTS]
+ */
+int main(int argc, char **argv)
+{
+    if (argc == 3 && std::strcmp(argv[1], "--child") == 0)
+    {
+        if (machine.TryLoadROM(FOOTPRINT_ROM, sizeof(FOOTPRINT_ROM)) != RomError::None)
+        {
+            return EXIT_FAILURE;
+        }
+        machine.Tick();
+        long long elapsed = Now() - std::atoll(argv[2]);
+        std::printf("%lld\n", elapsed);
+        return machine.PC() == 0x202 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+#ifndef _WIN32
+    unsigned int starts = argc > 1 ? std::atoi(argv[1]) : DEFAULT_STARTS;
+    long long total = 0;
+    long long best = -1;
+    for (unsigned int i = 0; i < starts; ++i)
+    {
+        int output[2];
+        if (pipe(output) != 0)
+        {
+            std::perror("ERROR: pipe");
+            return EXIT_FAILURE;
+        }
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, output[1], STDOUT_FILENO);
+        posix_spawn_file_actions_addclose(&actions, output[0]);
+
+        char start[32];
+        std::snprintf(start, sizeof(start), "%lld", Now());
+        char child[] = "--child";
+        char *arguments[] = {argv[0], child, start, nullptr};
+        pid_t pid;
+        int spawned = posix_spawn(&pid, argv[0], &actions, nullptr, arguments, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        close(output[1]);
+
+        char reply[32]{};
+        ssize_t length = spawned == 0 ? read(output[0], reply, sizeof(reply) - 1) : -1;
+        close(output[0]);
+        int status = 0;
+        if (spawned == 0)
+        {
+            waitpid(pid, &status, 0);
+        }
+        if (length <= 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            std::fprintf(stderr, "ERROR: Start %u failed\n", i);
+            return EXIT_FAILURE;
+        }
+
+        long long elapsed = std::atoll(reply);
+        total += elapsed;
+        best = best < 0 || elapsed < best ? elapsed : best;
+    }
+
+    std::printf("LOG: machine is %zu bytes of static state\n", sizeof(machine));
+    std::printf("LOG: %u starts, first instruction after %.1fus on average, %.1fus at best\n",
+                starts, total / 1000.0 / starts, best / 1000.0);
+#endif
+    return EXIT_SUCCESS;
+}
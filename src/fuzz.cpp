@@ -0,0 +1,939 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "chip8.hpp"
+
+const unsigned int FUZZ_START_ADDRESS = 0x200;
+const unsigned int MAX_PROGRAM_WORDS = 64;
+const unsigned int MAX_STEPS = 256;
+const unsigned int MAX_FINDINGS = 8;
+const unsigned int DEFAULT_FUZZ_SECONDS = 10;
+
+// Handler ids used for coverage, one per distinct instruction + unknown
+const unsigned int KIND_COUNT = 51;
+const unsigned int KIND_NULL = KIND_COUNT - 1;
+
+/** @brief Straightforward switch based interpreter written from the CHIP-8,
+ *         SUPER-CHIP and XO-CHIP specifications. It works on a copy of
+ *         Chip8State pixel by pixel and wraps and counts memory, stack and
+ *         keypad accesses that are out of range the same way safe Chip8 does.
+ */
+template <typename Quirks>
+struct Reference
+{
+    Chip8State state;
+    const uint8_t *keypad;
+    std::default_random_engine randGen;
+    std::uniform_int_distribution<unsigned int> randByte{0, 255U};
+    unsigned int kind = KIND_NULL;
+    uint32_t outOfRange = 0;
+    // Memory the last step stored to, the only part of it that can have changed
+    unsigned int written = 0;
+    unsigned int writtenLength = 0;
+
+    /// @brief Start over from machine state in place, nothing of the previous run stays
+    void Reset(const Chip8Base &chip8, unsigned int seed)
+    {
+        chip8.GetState(state);
+        keypad = chip8.keypad;
+        randGen.seed(seed);
+        randByte.reset();
+        kind = KIND_NULL;
+        outOfRange = 0;
+        writtenLength = 0;
+    }
+
+    void Written(unsigned int address, unsigned int length)
+    {
+        written = address;
+        writtenLength = length;
+    }
+
+    uint8_t &Memory(unsigned int address)
+    {
+        outOfRange += address >= Quirks::memorySize;
+        return state.memory[address % Quirks::memorySize];
+    }
+
+    uint16_t &Stack(unsigned int slot)
+    {
+        outOfRange += slot >= STACK_SIZE;
+        return state.stack[slot % STACK_SIZE];
+    }
+
+    uint8_t Key(unsigned int key)
+    {
+        outOfRange += key >= KEYPAD_SIZE;
+        return keypad[key % KEYPAD_SIZE];
+    }
+
+    unsigned int Width() const
+    {
+        return state.hires ? HIRES_VIDEO_WIDTH : VIDEO_WIDTH;
+    }
+
+    unsigned int Height() const
+    {
+        return state.hires ? HIRES_VIDEO_HEIGHT : VIDEO_HEIGHT;
+    }
+
+    static VideoRow Bit(unsigned int x)
+    {
+        return static_cast<VideoRow>(1) << (HIRES_VIDEO_WIDTH - 1 - x);
+    }
+
+    void Skip(bool condition)
+    {
+        if (!condition)
+        {
+            return;
+        }
+        if (Quirks::xoChip && ((Memory(state.pc) << 8u) | Memory(state.pc + 1u)) == 0xF000)
+        {
+            state.pc += 2;
+        }
+        state.pc += 2;
+    }
+
+    /// @brief Move every pixel of selected planes by dx, dy dropping what leaves the screen
+    void Scroll(int dx, int dy)
+    {
+        for (unsigned int plane = 0; plane < VIDEO_PLANES; ++plane)
+        {
+            if (!(state.planes & (1u << plane)))
+            {
+                continue;
+            }
+            VideoRow scrolled[HIRES_VIDEO_HEIGHT]{};
+            for (int y = 0; y < static_cast<int>(Height()); ++y)
+            {
+                for (int x = 0; x < static_cast<int>(Width()); ++x)
+                {
+                    int fromX = x - dx;
+                    int fromY = y - dy;
+                    if (fromX >= 0 && fromX < static_cast<int>(Width()) && fromY >= 0 && fromY < static_cast<int>(Height()) &&
+                        (state.video[plane][fromY] & Bit(fromX)))
+                    {
+                        scrolled[y] |= Bit(x);
+                    }
+                }
+            }
+            std::memcpy(state.video[plane], scrolled, sizeof(scrolled));
+        }
+    }
+
+    /// @brief Execute one instruction
+    void Step()
+    {
+        Chip8State &s = state;
+        uint16_t opcode = (Memory(s.pc) << 8u) | Memory(s.pc + 1u);
+        uint8_t x = (opcode & 0x0F00u) >> 8u;
+        uint8_t y = (opcode & 0x00F0u) >> 4u;
+        uint8_t n = opcode & 0x000Fu;
+        uint8_t kk = opcode & 0x00FFu;
+        uint16_t nnn = opcode & 0x0FFFu;
+        uint8_t *V = s.registers;
+
+        s.pc += 2;
+        kind = KIND_NULL;
+        writtenLength = 0;
+
+        switch (opcode >> 12u)
+        {
+        case 0x0:
+            if (kk == 0xE0)
+            {
+                kind = 0;
+                for (unsigned int plane = 0; plane < VIDEO_PLANES; ++plane)
+                {
+                    if (s.planes & (1u << plane))
+                    {
+                        std::memset(s.video[plane], 0, sizeof(s.video[plane]));
+                    }
+                }
+            }
+            else if (kk == 0xEE)
+            {
+                kind = 1;
+                s.pc = Stack(--s.sp);
+            }
+            else if (Quirks::superChip && (kk & 0xF0u) == 0xC0)
+            {
+                kind = 34;
+                Scroll(0, n);
+            }
+            else if (Quirks::xoChip && (kk & 0xF0u) == 0xD0)
+            {
+                kind = 35;
+                Scroll(0, -n);
+            }
+            else if (Quirks::superChip && kk == 0xFB)
+            {
+                kind = 36;
+                Scroll(4, 0);
+            }
+            else if (Quirks::superChip && kk == 0xFC)
+            {
+                kind = 37;
+                Scroll(-4, 0);
+            }
+            else if (Quirks::superChip && kk == 0xFD)
+            {
+                kind = 38;
+                s.pc -= 2;
+            }
+            else if (Quirks::superChip && (kk == 0xFE || kk == 0xFF))
+            {
+                kind = kk == 0xFE ? 39 : 40;
+                s.hires = kk == 0xFF;
+                std::memset(s.video, 0, sizeof(s.video));
+            }
+            break;
+        case 0x1:
+            kind = 2;
+            s.pc = nnn;
+            break;
+        case 0x2:
+            kind = 3;
+            Stack(s.sp++) = s.pc;
+            s.pc = nnn;
+            break;
+        case 0x3:
+            kind = 4;
+            Skip(V[x] == kk);
+            break;
+        case 0x4:
+            kind = 5;
+            Skip(V[x] != kk);
+            break;
+        case 0x5:
+            if (!Quirks::xoChip || n == 0x0)
+            {
+                kind = 6;
+                Skip(V[x] == V[y]);
+            }
+            else if (n == 0x2 || n == 0x3)
+            {
+                kind = n == 0x2 ? 44 : 45;
+                int step = x <= y ? 1 : -1;
+                if (n == 0x2)
+                {
+                    Written(s.index, (x <= y ? y - x : x - y) + 1u);
+                }
+                for (int i = 0, r = x;; ++i, r += step)
+                {
+                    if (n == 0x2)
+                        Memory(s.index + i) = V[r];
+                    else
+                        V[r] = Memory(s.index + i);
+                    if (r == y)
+                        break;
+                }
+            }
+            break;
+        case 0x6:
+            kind = 7;
+            V[x] = kk;
+            break;
+        case 0x7:
+            kind = 8;
+            V[x] += kk;
+            break;
+        case 0x8:
+        {
+            uint8_t vx = V[x];
+            uint8_t vy = V[y];
+            switch (n)
+            {
+            case 0x0:
+                kind = 9;
+                V[x] = vy;
+                break;
+            case 0x1:
+                kind = 10;
+                V[x] = vx | vy;
+                V[0xF] = Quirks::logicResetsVF ? 0 : V[0xF];
+                break;
+            case 0x2:
+                kind = 11;
+                V[x] = vx & vy;
+                V[0xF] = Quirks::logicResetsVF ? 0 : V[0xF];
+                break;
+            case 0x3:
+                kind = 12;
+                V[x] = vx ^ vy;
+                V[0xF] = Quirks::logicResetsVF ? 0 : V[0xF];
+                break;
+            case 0x4:
+                kind = 13;
+                V[x] = vx + vy;
+                V[0xF] = (vx + vy) > 255U;
+                break;
+            case 0x5:
+                kind = 14;
+                V[x] = vx - vy;
+                V[0xF] = vx > vy;
+                break;
+            case 0x6:
+            {
+                kind = 15;
+                uint8_t source = Quirks::shiftReadsVy ? vy : vx;
+                V[x] = source >> 1;
+                V[0xF] = source & 0x1u;
+            }
+            break;
+            case 0x7:
+                kind = 16;
+                V[x] = vy - vx;
+                V[0xF] = vy > vx;
+                break;
+            case 0xE:
+            {
+                kind = 17;
+                uint8_t source = Quirks::shiftReadsVy ? vy : vx;
+                V[x] = source << 1;
+                V[0xF] = source >> 7u;
+            }
+            break;
+            }
+        }
+        break;
+        case 0x9:
+            kind = 18;
+            Skip(V[x] != V[y]);
+            break;
+        case 0xA:
+            kind = 19;
+            s.index = nnn;
+            break;
+        case 0xB:
+            kind = 20;
+            s.pc = nnn + (Quirks::jumpUsesVx ? V[x] : V[0]);
+            break;
+        case 0xC:
+            kind = 21;
+            V[x] = randByte(randGen) & kk;
+            break;
+        case 0xD:
+        {
+            kind = 22;
+            unsigned int xPos = V[x] % Width();
+            unsigned int yPos = V[y] % Height();
+            unsigned int spriteWidth = Quirks::superChip && n == 0 ? 16 : 8;
+            unsigned int rows = Quirks::superChip && n == 0 ? 16 : n;
+            unsigned int address = s.index;
+            bool collision = false;
+            for (unsigned int plane = 0; plane < VIDEO_PLANES; ++plane)
+            {
+                if (!(s.planes & (1u << plane)))
+                {
+                    continue;
+                }
+                for (unsigned int row = 0; row < rows; ++row)
+                {
+                    unsigned int bits = Memory(address++);
+                    if (spriteWidth == 16)
+                    {
+                        bits = (bits << 8u) | Memory(address++);
+                    }
+                    unsigned int py = yPos + row;
+                    if (py >= Height() && !Quirks::spritesWrap)
+                    {
+                        continue;
+                    }
+                    py %= Height();
+                    for (unsigned int column = 0; column < spriteWidth; ++column)
+                    {
+                        unsigned int px = xPos + column;
+                        if (!((bits >> (spriteWidth - 1 - column)) & 0x1u) || (px >= Width() && !Quirks::spritesWrap))
+                        {
+                            continue;
+                        }
+                        px %= Width();
+                        collision |= (s.video[plane][py] & Bit(px)) != 0;
+                        s.video[plane][py] ^= Bit(px);
+                    }
+                }
+            }
+            V[0xF] = collision;
+        }
+        break;
+        case 0xE:
+            if (n == 0xE)
+            {
+                kind = 23;
+                Skip(Key(V[x]));
+            }
+            else if (n == 0x1)
+            {
+                kind = 24;
+                Skip(!Key(V[x]));
+            }
+            break;
+        case 0xF:
+            switch (kk)
+            {
+            case 0x07:
+                kind = 25;
+                V[x] = s.delayTimer;
+                break;
+            case 0x0A:
+            {
+                kind = 26;
+                unsigned int key = 0;
+                while (key < KEYPAD_SIZE && !keypad[key])
+                {
+                    ++key;
+                }
+                if (key < KEYPAD_SIZE)
+                {
+                    V[x] = key;
+                }
+                else
+                {
+                    s.pc -= 2;
+                }
+            }
+            break;
+            case 0x15:
+                kind = 27;
+                s.delayTimer = V[x];
+                break;
+            case 0x18:
+                kind = 28;
+                s.soundTimer = V[x];
+                break;
+            case 0x1E:
+                kind = 29;
+                s.index += V[x];
+                break;
+            case 0x29:
+                kind = 30;
+                s.index = 0x050 + 5 * V[x];
+                break;
+            case 0x33:
+                kind = 31;
+                Written(s.index, 3);
+                Memory(s.index + 2u) = V[x] % 10;
+                Memory(s.index + 1u) = (V[x] / 10) % 10;
+                Memory(s.index) = V[x] / 100;
+                break;
+            case 0x55:
+                kind = 32;
+                Written(s.index, x + 1u);
+                for (unsigned int i = 0; i <= x; ++i)
+                {
+                    Memory(s.index + i) = V[i];
+                }
+                s.index += Quirks::loadStoreIncrementsIndex ? x + 1u : 0;
+                break;
+            case 0x30:
+                if (Quirks::superChip)
+                {
+                    kind = 41;
+                    s.index = 0x0A0 + 10 * (V[x] & 0xFu);
+                }
+                break;
+            case 0x75:
+            case 0x85:
+                if (Quirks::superChip)
+                {
+                    kind = kk == 0x75 ? 42 : 43;
+                    for (unsigned int i = 0; i <= x; ++i)
+                    {
+                        if (kk == 0x75)
+                            s.flags[i] = V[i];
+                        else
+                            V[i] = s.flags[i];
+                    }
+                }
+                break;
+            case 0x00:
+                if (Quirks::xoChip)
+                {
+                    kind = 46;
+                    s.index = (Memory(s.pc) << 8u) | Memory(s.pc + 1u);
+                    s.pc += 2;
+                }
+                break;
+            case 0x01:
+                if (Quirks::xoChip)
+                {
+                    kind = 47;
+                    s.planes = x & 0x3u;
+                }
+                break;
+            case 0x02:
+                if (Quirks::xoChip)
+                {
+                    kind = 48;
+                    for (unsigned int i = 0; i < AUDIO_PATTERN_SIZE; ++i)
+                    {
+                        s.audioPattern[i] = Memory(s.index + i);
+                    }
+                }
+                break;
+            case 0x3A:
+                if (Quirks::xoChip)
+                {
+                    kind = 49;
+                    s.pitch = V[x];
+                }
+                break;
+            case 0x65:
+                kind = 33;
+                for (unsigned int i = 0; i <= x; ++i)
+                {
+                    V[i] = Memory(s.index + i);
+                }
+                s.index += Quirks::loadStoreIncrementsIndex ? x + 1u : 0;
+                break;
+            }
+            break;
+        }
+
+        if (s.delayTimer > 0)
+        {
+            --s.delayTimer;
+        }
+        if (s.soundTimer > 0)
+        {
+            --s.soundTimer;
+        }
+    }
+};
+
+/// @brief Name of the first field outside memory in which two states differ or nullptr
+const char *Compare(const Chip8State &a, const Chip8State &b)
+{
+    if (std::memcmp(a.registers, b.registers, sizeof(a.registers)))
+        return "registers";
+    if (a.index != b.index)
+        return "index";
+    if (a.pc != b.pc)
+        return "pc";
+    if (a.sp != b.sp)
+        return "sp";
+    if (std::memcmp(a.stack, b.stack, sizeof(a.stack)))
+        return "stack";
+    if (a.delayTimer != b.delayTimer)
+        return "delayTimer";
+    if (a.soundTimer != b.soundTimer)
+        return "soundTimer";
+    if (std::memcmp(a.video, b.video, sizeof(a.video)))
+        return "video";
+    if (a.hires != b.hires)
+        return "hires";
+    if (a.planes != b.planes)
+        return "planes";
+    if (std::memcmp(a.flags, b.flags, sizeof(a.flags)))
+        return "flags";
+    if (std::memcmp(a.audioPattern, b.audioPattern, sizeof(a.audioPattern)))
+        return "audioPattern";
+    if (a.pitch != b.pitch)
+        return "pitch";
+    return nullptr;
+}
+
+/// @brief One generated test case
+struct FuzzCase
+{
+    std::vector<uint16_t> program;
+    uint16_t keys;
+    unsigned int seed;
+    QuirkProfile profile;
+};
+
+/// @brief Outcome of running a FuzzCase through both interpreters
+struct FuzzResult
+{
+    unsigned int steps = 0;
+    uint32_t outOfRange = 0;
+    const char *divergence = nullptr;
+};
+
+/// @brief True when engine memory equals reference memory over a range, which wraps like addresses do
+template <typename Quirks>
+bool SameMemory(const Reference<Quirks> &reference, const Chip8Base &chip8, unsigned int address, unsigned int length)
+{
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        unsigned int wrapped = (address + i) % Quirks::memorySize;
+        if (reference.state.memory[wrapped] != chip8.Memory()[wrapped])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Run case through Chip8 and Reference comparing state after every
+ *         step. Memory is compared where the step stored to, and as a whole
+ *         once the run is over in case the engine stored somewhere else
+ */
+template <typename Quirks>
+FuzzResult Execute(const FuzzCase &fuzzCase, std::vector<bool> *coverage)
+{
+    FuzzResult result;
+
+    std::vector<uint8_t> rom;
+    for (uint16_t word : fuzzCase.program)
+    {
+        rom.push_back(word >> 8u);
+        rom.push_back(word & 0xFFu);
+    }
+
+    // Engine under test
+    Chip8<Quirks> chip8;
+    chip8.Seed(fuzzCase.seed);
+    if (!rom.empty())
+    {
+        chip8.LoadROM(rom.data(), rom.size());
+    }
+    for (unsigned int key = 0; key < KEYPAD_SIZE; ++key)
+    {
+        chip8.keypad[key] = (fuzzCase.keys >> key) & 0x1u;
+    }
+
+    static thread_local Reference<Quirks> reference;
+    static thread_local Chip8State engineState;
+    reference.Reset(chip8, fuzzCase.seed);
+
+    unsigned int lastKind = KIND_NULL;
+    for (; result.steps < MAX_STEPS; ++result.steps)
+    {
+        reference.Step();
+        chip8.Tick();
+        chip8.GetStateWithoutMemory(engineState);
+
+        if (coverage)
+        {
+            (*coverage)[lastKind * KIND_COUNT + reference.kind] = true;
+            lastKind = reference.kind;
+        }
+
+        result.divergence = Compare(reference.state, engineState);
+        if (!result.divergence && !SameMemory(reference, chip8, reference.written, reference.writtenLength))
+        {
+            result.divergence = "memory";
+        }
+        if (!result.divergence && reference.outOfRange != chip8.OutOfRangeAccesses())
+        {
+            result.divergence = "outOfRange";
+        }
+        if (result.divergence)
+        {
+            break;
+        }
+    }
+
+    if (!result.divergence && !SameMemory(reference, chip8, 0, Quirks::memorySize))
+    {
+        result.divergence = "memory";
+    }
+    result.outOfRange = reference.outOfRange;
+
+    return result;
+}
+
+/// @brief Run case with interpreter pair for its quirk profile
+FuzzResult Execute(const FuzzCase &fuzzCase, std::vector<bool> *coverage)
+{
+    switch (fuzzCase.profile)
+    {
+    case QuirkProfile::CosmacVIP:
+        return Execute<QuirksCosmacVIP>(fuzzCase, coverage);
+    case QuirkProfile::SuperChip:
+        return Execute<QuirksSuperChip>(fuzzCase, coverage);
+    case QuirkProfile::XOChip:
+        return Execute<QuirksXOChip>(fuzzCase, coverage);
+    default:
+        return Execute<QuirksChip8>(fuzzCase, coverage);
+    }
+}
+
+/// @brief Greedily drop instructions while the case still diverges
+FuzzCase Minimize(FuzzCase fuzzCase)
+{
+    bool progress = true;
+    while (progress)
+    {
+        progress = false;
+        for (size_t i = fuzzCase.program.size(); i-- > 0;)
+        {
+            FuzzCase candidate = fuzzCase;
+            candidate.program.erase(candidate.program.begin() + i);
+            if (Execute(candidate, nullptr).divergence)
+            {
+                fuzzCase = candidate;
+                progress = true;
+            }
+        }
+    }
+    return fuzzCase;
+}
+
+/// @brief Generate random instruction, biased towards encodings Chip8 defines
+uint16_t RandomInstruction(std::mt19937 &rng, size_t programWords)
+{
+    static const uint8_t table8Ops[] = {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE};
+    static const uint8_t tableFOps[] = {0x07, 0x0A, 0x15, 0x18, 0x1E, 0x29, 0x33, 0x55, 0x65,
+                                        0x30, 0x75, 0x85, 0x00, 0x01, 0x02, 0x3A};
+    static const uint8_t table0Ops[] = {0xE0, 0xEE, 0xE0, 0xEE, 0xC0, 0xD0, 0xFB, 0xFC, 0xFE, 0xFF};
+
+    uint16_t x = (rng() & 0xFu) << 8u;
+    uint16_t y = (rng() & 0xFu) << 4u;
+    uint16_t kk = rng() & 0xFFu;
+    // Jumps mostly land inside the program
+    uint16_t nnn = (rng() % 4) ? FUZZ_START_ADDRESS + 2 * (rng() % (programWords + 1)) : rng() & 0xFFFu;
+
+    switch (rng() & 0xFu)
+    {
+    case 0x0:
+    {
+        // 00FD halts the program so it is rare
+        uint16_t op = (rng() % 64) ? table0Ops[rng() % 10] : 0xFD;
+        return ((op & 0xF0u) == 0xC0 || (op & 0xF0u) == 0xD0) ? op | (rng() & 0xFu) : op;
+    }
+    case 0x8:
+        return 0x8000 | x | y | ((rng() % 8) ? table8Ops[rng() % 9] : rng() & 0xFu);
+    case 0xD:
+        return 0xD000 | x | y | (rng() & 0xFu);
+    case 0xE:
+        return 0xE000 | x | ((rng() & 0x1u) ? 0x9E : 0xA1);
+    case 0xF:
+        return 0xF000 | x | ((rng() % 8) ? tableFOps[rng() % 16] : kk);
+    case 0x5:
+    case 0x9:
+        return ((rng() & 0x1u) ? 0x5000 | (rng() % 4) : 0x9000) | x | y;
+    case 0x1:
+    case 0x2:
+    case 0xA:
+    case 0xB:
+    {
+        static const uint16_t nnnOps[] = {0x1000, 0x2000, 0xA000, 0xB000};
+        return nnnOps[rng() & 0x3u] | nnn;
+    }
+    default:
+    {
+        static const uint16_t kkOps[] = {0x3000, 0x4000, 0x6000, 0x7000, 0xC000};
+        return kkOps[rng() % 5] | x | kk;
+    }
+    }
+}
+
+/// @brief Mutate a corpus entry by replacing, inserting, removing or splicing instructions
+void Mutate(FuzzCase &fuzzCase, const std::vector<FuzzCase> &corpus, std::mt19937 &rng)
+{
+    std::vector<uint16_t> &program = fuzzCase.program;
+    unsigned int mutations = 1 + rng() % 4;
+    for (unsigned int m = 0; m < mutations; ++m)
+    {
+        switch (rng() % 5)
+        {
+        case 0:
+            if (!program.empty())
+                program[rng() % program.size()] = RandomInstruction(rng, program.size());
+            break;
+        case 1:
+            if (!program.empty())
+                program[rng() % program.size()] ^= 0xFu << (4 * (rng() % 4));
+            break;
+        case 2:
+            if (program.size() < MAX_PROGRAM_WORDS)
+                program.insert(program.begin() + rng() % (program.size() + 1), RandomInstruction(rng, program.size()));
+            break;
+        case 3:
+            if (program.size() > 1)
+                program.erase(program.begin() + rng() % program.size());
+            break;
+        case 4:
+        {
+            const std::vector<uint16_t> &other = corpus[rng() % corpus.size()].program;
+            size_t cut = rng() % (program.size() + 1);
+            program.resize(cut);
+            for (size_t i = rng() % (other.size() + 1); i < other.size() && program.size() < MAX_PROGRAM_WORDS; ++i)
+                program.push_back(other[i]);
+        }
+        break;
+        }
+    }
+    fuzzCase.keys ^= (rng() % 4) ? 0 : 1u << (rng() % KEYPAD_SIZE);
+    fuzzCase.seed = rng();
+}
+
+struct FuzzShared
+{
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> execs{0};
+    std::atomic<uint64_t> steps{0};
+    std::atomic<uint64_t> outOfRange{0};
+    std::atomic<unsigned int> findings{0};
+    std::atomic<unsigned int> edges{0};
+    std::atomic<bool> coverage[KIND_COUNT * KIND_COUNT]{};
+    std::mutex reportMutex;
+};
+
+/// @brief Print minimized program and store it as ROM next to the fuzzer
+void Report(FuzzShared &shared, const FuzzCase &original, unsigned int finding)
+{
+    FuzzCase minimized = Minimize(original);
+    FuzzResult result = Execute(minimized, nullptr);
+
+    std::ostringstream name;
+    name << "fuzz-divergence-" << finding << ".ch8";
+    std::ofstream file(name.str(), std::ios::binary);
+    for (uint16_t word : minimized.program)
+    {
+        file.put(static_cast<char>(word >> 8u));
+        file.put(static_cast<char>(word & 0xFFu));
+    }
+
+    std::lock_guard<std::mutex> lock(shared.reportMutex);
+    std::cout << "DIVERGENCE: " << result.divergence << " after step " << result.steps
+              << " (profile " << static_cast<int>(minimized.profile)
+              << ", keys " << std::hex << minimized.keys << std::dec << ", seed " << minimized.seed << ")"
+              << std::endl
+              << "  program:" << std::hex;
+    for (uint16_t word : minimized.program)
+    {
+        std::cout << " " << word;
+    }
+    std::cout << std::dec << std::endl
+              << "  saved as " << name.str() << std::endl;
+}
+
+/// @brief Fuzzing loop run by every worker thread
+void Worker(FuzzShared &shared, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<FuzzCase> corpus;
+    std::vector<bool> coverage(KIND_COUNT * KIND_COUNT);
+    uint64_t execs = 0;
+    uint64_t steps = 0;
+    uint64_t outOfRange = 0;
+
+    while (!shared.stop.load(std::memory_order_relaxed))
+    {
+        FuzzCase fuzzCase;
+        if (!corpus.empty() && rng() % 4)
+        {
+            fuzzCase = corpus[rng() % corpus.size()];
+            Mutate(fuzzCase, corpus, rng);
+        }
+        else
+        {
+            size_t length = 1 + rng() % MAX_PROGRAM_WORDS;
+            for (size_t i = 0; i < length; ++i)
+            {
+                fuzzCase.program.push_back(RandomInstruction(rng, length));
+            }
+            fuzzCase.keys = (rng() % 2) ? rng() & 0xFFFFu : 0;
+            fuzzCase.seed = rng();
+            fuzzCase.profile = static_cast<QuirkProfile>(rng() % 4);
+        }
+
+        std::vector<bool> before = coverage;
+        FuzzResult result = Execute(fuzzCase, &coverage);
+        ++execs;
+        steps += result.steps;
+        outOfRange += result.outOfRange;
+
+        // Keep cases that reach new handler pairs
+        if (coverage != before)
+        {
+            for (size_t edge = 0; edge < coverage.size(); ++edge)
+            {
+                if (coverage[edge] && !shared.coverage[edge].exchange(true, std::memory_order_relaxed))
+                {
+                    shared.edges.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            corpus.push_back(fuzzCase);
+        }
+
+        if (result.divergence)
+        {
+            unsigned int finding = shared.findings.fetch_add(1);
+            if (finding < MAX_FINDINGS)
+            {
+                Report(shared, fuzzCase, finding);
+            }
+            else
+            {
+                shared.stop = true;
+            }
+        }
+
+        if ((execs & 0xFFu) == 0)
+        {
+            shared.execs.fetch_add(execs, std::memory_order_relaxed);
+            shared.steps.fetch_add(steps, std::memory_order_relaxed);
+            shared.outOfRange.fetch_add(outOfRange, std::memory_order_relaxed);
+            execs = steps = outOfRange = 0;
+        }
+    }
+
+    shared.execs.fetch_add(execs);
+    shared.steps.fetch_add(steps);
+    shared.outOfRange.fetch_add(outOfRange);
+}
+
+/** @brief Differential fuzzer. Runs generated and coverage guided instruction
+ *         streams through Chip8::Tick and a reference interpreter for every
+ *         quirk profile on every core and minimizes any program for which their state differs.
+ *         usage: fuzz [seconds] [threads] [seed]
+ */
+int main(int argc, char **argv)
+{
+    unsigned int seconds = argc > 1 ? std::stoul(argv[1]) : DEFAULT_FUZZ_SECONDS;
+    unsigned int threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    unsigned int seed = argc > 3 ? std::stoul(argv[3]) : std::random_device{}();
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+
+    std::cout << "LOG: fuzzing for " << seconds << "s on " << threads << " threads, seed " << seed << std::endl;
+
+    FuzzShared shared;
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(Worker, std::ref(shared), seed + i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t lastExecs = 0;
+    for (unsigned int second = 0; second < seconds && !shared.stop; ++second)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        uint64_t execs = shared.execs.load();
+        std::cout << "LOG: " << (execs - lastExecs) << " execs/s, " << execs << " total, "
+                  << shared.edges.load() << " edges, " << shared.findings.load() << " divergences" << std::endl;
+        lastExecs = execs;
+    }
+
+    shared.stop = true;
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "LOG: " << shared.execs << " execs (" << static_cast<uint64_t>(shared.execs / elapsed) << "/s), "
+              << shared.steps << " steps (" << static_cast<uint64_t>(shared.steps / elapsed) << "/s), "
+              << shared.outOfRange << " out of range accesses wrapped, "
+              << shared.findings << " divergences" << std::endl;
+
+    return shared.findings ? EXIT_FAILURE : EXIT_SUCCESS;
+}
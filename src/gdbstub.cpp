@@ -0,0 +1,594 @@
+#include "gdbstub.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// V0-VF, I, PC, SP, DT, ST
+const unsigned int GDB_REGISTER_COUNT = REGISTER_SIZE + 5;
+const size_t GDB_RECEIVE_SIZE = 4096;
+// Longest wait for a slow client to take more of a reply before it is dropped
+const int GDB_SEND_TIMEOUT_MILLISECONDS = 1000;
+const char *GDB_HEX_DIGITS = "0123456789abcdef";
+
+// Register layout of g packets, so gdb names and sizes registers without knowing CHIP-8
+const char *GDB_TARGET_XML =
+    "<?xml version=\"1.0\"?>"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target version=\"1.0\">"
+    "<feature name=\"org.chip8.core\">"
+    "<reg name=\"v0\" bitsize=\"8\" type=\"uint8\" regnum=\"0\"/>"
+    "<reg name=\"v1\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v2\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v3\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v4\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v5\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v6\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v7\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v8\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v9\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"va\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"vb\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"vc\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"vd\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"ve\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"vf\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"i\" bitsize=\"16\" type=\"data_ptr\"/>"
+    "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+    "<reg name=\"sp\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"dt\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"st\" bitsize=\"8\" type=\"uint8\"/>"
+    "</feature>"
+    "</target>";
+
+/// @brief Bytes as two lowercase hex digits each
+static std::string Hex(const uint8_t *data, size_t size)
+{
+    std::string hex;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hex += GDB_HEX_DIGITS[data[i] >> 4u];
+        hex += GDB_HEX_DIGITS[data[i] & 0xFu];
+    }
+    return hex;
+}
+
+/// @brief Parse hex digits into bytes, false if any is not a hex digit
+static bool Unhex(const std::string &hex, uint8_t *data, size_t size)
+{
+    if (hex.size() < size * 2)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < size; ++i)
+    {
+        char pair[3] = {hex[2 * i], hex[2 * i + 1], 0};
+        char *end;
+        data[i] = std::strtoul(pair, &end, 16);
+        if (*end)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Register number in little endian bytes as gdb sees it
+static std::string RegisterHex(const Chip8State &state, unsigned int number)
+{
+    uint8_t bytes[2];
+    if (number < REGISTER_SIZE)
+    {
+        return Hex(&state.registers[number], 1);
+    }
+    switch (number)
+    {
+    case REGISTER_SIZE:
+        bytes[0] = state.index & 0xFFu;
+        bytes[1] = state.index >> 8u;
+        return Hex(bytes, 2);
+    case REGISTER_SIZE + 1:
+        bytes[0] = state.pc & 0xFFu;
+        bytes[1] = state.pc >> 8u;
+        return Hex(bytes, 2);
+    case REGISTER_SIZE + 2:
+        return Hex(&state.sp, 1);
+    case REGISTER_SIZE + 3:
+        return Hex(&state.delayTimer, 1);
+    default:
+        return Hex(&state.soundTimer, 1);
+    }
+}
+
+/// @brief Set register from hex, returns digits used or 0 on error
+static size_t SetRegisterHex(Chip8State &state, unsigned int number, const std::string &hex)
+{
+    uint8_t bytes[2];
+    bool wide = number == REGISTER_SIZE || number == REGISTER_SIZE + 1;
+    if (!Unhex(hex, bytes, wide ? 2 : 1))
+    {
+        return 0;
+    }
+    if (number < REGISTER_SIZE)
+        state.registers[number] = bytes[0];
+    else if (number == REGISTER_SIZE)
+        state.index = bytes[0] | (bytes[1] << 8u);
+    else if (number == REGISTER_SIZE + 1)
+        state.pc = bytes[0] | (bytes[1] << 8u);
+    else if (number == REGISTER_SIZE + 2)
+        state.sp = bytes[0];
+    else if (number == REGISTER_SIZE + 3)
+        state.delayTimer = bytes[0];
+    else
+        state.soundTimer = bytes[0];
+    return wide ? 4 : 2;
+}
+
+std::string GdbStub::StopReply() const
+{
+    char reply[32];
+    switch (debugger.Reason())
+    {
+    case StopReason::Interrupt:
+        return "S02";
+    case StopReason::WatchWrite:
+        std::snprintf(reply, sizeof(reply), "T05watch:%x;", debugger.StopAddress());
+        return reply;
+    case StopReason::WatchRead:
+        std::snprintf(reply, sizeof(reply), "T05rwatch:%x;", debugger.StopAddress());
+        return reply;
+    default:
+        return "S05";
+    }
+}
+
+/// @brief Answer one packet. c and s answer later with a stop reply
+std::string GdbStub::Handle(const std::string &packet, Chip8Base &chip8)
+{
+    static Chip8State state;
+    const char *arguments = packet.c_str() + 1;
+    char *end;
+
+    switch (packet[0])
+    {
+    case '?':
+        return StopReply();
+
+    case 'g':
+    {
+        chip8.GetState(state);
+        std::string reply;
+        for (unsigned int number = 0; number < GDB_REGISTER_COUNT; ++number)
+        {
+            reply += RegisterHex(state, number);
+        }
+        return reply;
+    }
+
+    case 'G':
+    {
+        chip8.GetState(state);
+        std::string hex(arguments);
+        size_t position = 0;
+        for (unsigned int number = 0; number < GDB_REGISTER_COUNT; ++number)
+        {
+            size_t used = SetRegisterHex(state, number, hex.substr(position));
+            if (!used)
+            {
+                return "E01";
+            }
+            position += used;
+        }
+        chip8.SetState(state);
+        return "OK";
+    }
+
+    case 'p':
+    {
+        unsigned long number = std::strtoul(arguments, nullptr, 16);
+        if (number >= GDB_REGISTER_COUNT)
+        {
+            return "E01";
+        }
+        chip8.GetState(state);
+        return RegisterHex(state, number);
+    }
+
+    case 'P':
+    {
+        unsigned long number = std::strtoul(arguments, &end, 16);
+        if (*end != '=' || number >= GDB_REGISTER_COUNT)
+        {
+            return "E01";
+        }
+        chip8.GetState(state);
+        if (!SetRegisterHex(state, number, end + 1))
+        {
+            return "E01";
+        }
+        chip8.SetState(state);
+        return "OK";
+    }
+
+    case 'm':
+    case 'M':
+    {
+        unsigned long address = std::strtoul(arguments, &end, 16);
+        unsigned long length = *end == ',' ? std::strtoul(end + 1, &end, 16) : 0;
+        // Compared without adding so lengths near ULONG_MAX cannot wrap into range
+        if (address > chip8.MemorySize() || length > chip8.MemorySize() - address)
+        {
+            return "E01";
+        }
+        if (packet[0] == 'm')
+        {
+            return Hex(chip8.Memory() + address, length);
+        }
+        chip8.GetState(state);
+        if (*end != ':' || !Unhex(end + 1, state.memory + address, length))
+        {
+            return "E01";
+        }
+        chip8.SetState(state);
+        return "OK";
+    }
+
+    case 'c':
+    case 's':
+    {
+        // Optional address to resume at
+        if (*arguments)
+        {
+            chip8.GetState(state);
+            state.pc = std::strtoul(arguments, nullptr, 16);
+            chip8.SetState(state);
+        }
+        if (packet[0] == 'c')
+            debugger.Continue();
+        else
+            debugger.Step();
+        running = true;
+        return "";
+    }
+
+    case 'Z':
+    case 'z':
+    {
+        bool enabled = packet[0] == 'Z';
+        unsigned long type = std::strtoul(arguments, &end, 16);
+        unsigned long address = *end == ',' ? std::strtoul(end + 1, &end, 16) : 0;
+        unsigned long length = *end == ',' ? std::strtoul(end + 1, &end, 16) : 1;
+        // Breakpoints only need their address inside memory, watchpoints their whole range
+        bool watched = type >= 2 && type <= 4;
+        if (address >= chip8.MemorySize() || (watched && length > chip8.MemorySize() - address))
+        {
+            return "E01";
+        }
+        switch (type)
+        {
+        case 0:
+        case 1:
+            debugger.SetBreakpoint(address, enabled);
+            return "OK";
+        case 2:
+            debugger.SetWatchpoint(address, length, WATCH_WRITE, enabled);
+            return "OK";
+        case 3:
+            debugger.SetWatchpoint(address, length, WATCH_READ, enabled);
+            return "OK";
+        case 4:
+            debugger.SetWatchpoint(address, length, WATCH_READ | WATCH_WRITE, enabled);
+            return "OK";
+        default:
+            return "";
+        }
+    }
+
+    case 'q':
+    {
+        if (packet.rfind("qSupported", 0) == 0)
+        {
+            return "PacketSize=1000;QStartNoAckMode+;qXfer:features:read+";
+        }
+        // qXfer:features:read:target.xml:OFFSET,LENGTH, m means more follows and l is the last part
+        if (packet.rfind("qXfer:features:read:target.xml:", 0) == 0)
+        {
+            unsigned long offset;
+            unsigned long length;
+            if (std::sscanf(packet.c_str() + 31, "%lx,%lx", &offset, &length) != 2)
+            {
+                return "E01";
+            }
+            std::string xml = GDB_TARGET_XML;
+            if (offset >= xml.size())
+            {
+                return "l";
+            }
+            std::string part = xml.substr(offset, length);
+            return (offset + part.size() < xml.size() ? "m" : "l") + part;
+        }
+        if (packet.rfind("qXfer:features:read:", 0) == 0)
+        {
+            return "E00";
+        }
+        if (packet == "qAttached")
+        {
+            return "1";
+        }
+        if (packet.rfind("qRcmd,", 0) == 0)
+        {
+            std::string hex = packet.substr(6);
+            std::string command(hex.size() / 2, '\0');
+            if (!Unhex(hex, reinterpret_cast<uint8_t *>(&command[0]), command.size()))
+            {
+                return "E01";
+            }
+            unsigned int reg;
+            if (std::sscanf(command.c_str(), "watch-reg %x", &reg) == 1 && reg < REGISTER_SIZE)
+            {
+                debugger.SetRegisterWatch(reg, true);
+                return "OK";
+            }
+            if (std::sscanf(command.c_str(), "unwatch-reg %x", &reg) == 1 && reg < REGISTER_SIZE)
+            {
+                debugger.SetRegisterWatch(reg, false);
+                return "OK";
+            }
+            return "E01";
+        }
+        return "";
+    }
+
+    case 'Q':
+        if (packet == "QStartNoAckMode")
+        {
+            return "OK";
+        }
+        return "";
+
+    case 'H':
+    case 'T':
+        return "OK";
+
+    case 'D':
+        return "OK";
+
+    default:
+        return "";
+    }
+}
+
+#ifndef _WIN32
+GdbStub::GdbStub(const char *address, Debugger &debugger) : debugger(debugger)
+{
+    char *end;
+    unsigned long port = std::strtoul(address, &end, 10);
+    bool tcp = *address && !*end;
+
+    if (tcp)
+    {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in local{};
+        local.sin_family = AF_INET;
+        local.sin_port = htons(port);
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0)
+        {
+            if (listenFd >= 0)
+                close(listenFd);
+            throw "GDB stub could not listen on port";
+        }
+    }
+    else
+    {
+        sockaddr_un local{};
+        if (std::strlen(address) >= sizeof(local.sun_path))
+        {
+            throw "GDB stub socket path is too long";
+        }
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        local.sun_family = AF_UNIX;
+        std::strcpy(local.sun_path, address);
+        unlink(address);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0)
+        {
+            if (listenFd >= 0)
+                close(listenFd);
+            throw "GDB stub could not listen on socket";
+        }
+        path = address;
+    }
+
+    listen(listenFd, 1);
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+}
+
+GdbStub::~GdbStub()
+{
+    if (clientFd >= 0)
+    {
+        Disconnect();
+    }
+    close(listenFd);
+    if (!path.empty())
+    {
+        unlink(path.c_str());
+    }
+}
+
+/// @brief Take waiting client, machine stops so it can look around
+void GdbStub::Accept()
+{
+    clientFd = accept(listenFd, nullptr, nullptr);
+    if (clientFd < 0)
+    {
+        return;
+    }
+    fcntl(clientFd, F_SETFL, fcntl(clientFd, F_GETFL) | O_NONBLOCK);
+    int noDelay = 1;
+    setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    debugger.Stop(StopReason::Attach);
+}
+
+/// @brief Drop client and let machine run freely again
+void GdbStub::Disconnect()
+{
+    close(clientFd);
+    clientFd = -1;
+    input.clear();
+    noAck = false;
+    running = false;
+    debugger.Clear();
+    debugger.Continue();
+}
+
+void GdbStub::Send(const std::string &payload)
+{
+    unsigned int checksum = 0;
+    for (char c : payload)
+    {
+        checksum += static_cast<uint8_t>(c);
+    }
+    char trailer[4];
+    std::snprintf(trailer, sizeof(trailer), "#%02x", checksum & 0xFFu);
+    std::string packet = "$" + payload + trailer;
+
+    size_t sent = 0;
+    while (sent < packet.size())
+    {
+        ssize_t count = send(clientFd, packet.data() + sent, packet.size() - sent, MSG_NOSIGNAL);
+        if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            return;
+        }
+        if (count < 0)
+        {
+            // Socket buffer is full, sleep until client reads instead of spinning
+            pollfd writable{clientFd, POLLOUT, 0};
+            if (poll(&writable, 1, GDB_SEND_TIMEOUT_MILLISECONDS) <= 0)
+            {
+                return;
+            }
+            continue;
+        }
+        sent += count;
+    }
+}
+
+/// @brief Accept client, answer every complete packet and report stops, never blocks
+void GdbStub::Poll(Chip8Base &chip8)
+{
+    if (clientFd < 0)
+    {
+        Accept();
+        if (clientFd < 0)
+        {
+            return;
+        }
+    }
+
+    char buffer[GDB_RECEIVE_SIZE];
+    ssize_t count;
+    while ((count = recv(clientFd, buffer, sizeof(buffer), 0)) > 0)
+    {
+        input.append(buffer, count);
+    }
+    if (count == 0 || (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        Disconnect();
+        return;
+    }
+
+    size_t position = 0;
+    while (position < input.size())
+    {
+        char c = input[position];
+        if (c == 0x03)
+        {
+            debugger.Stop(StopReason::Interrupt);
+            ++position;
+            continue;
+        }
+        if (c != '$')
+        {
+            // Acks and anything between packets
+            ++position;
+            continue;
+        }
+
+        size_t hash = input.find('#', position);
+        if (hash == std::string::npos || hash + 2 >= input.size())
+        {
+            break;
+        }
+        std::string packet = input.substr(position + 1, hash - position - 1);
+        unsigned int checksum = 0;
+        for (char p : packet)
+        {
+            checksum += static_cast<uint8_t>(p);
+        }
+        bool valid = (checksum & 0xFFu) == std::strtoul(input.substr(hash + 1, 2).c_str(), nullptr, 16);
+        position = hash + 3;
+
+        if (!noAck)
+        {
+            send(clientFd, valid ? "+" : "-", 1, MSG_NOSIGNAL);
+        }
+        if (!valid || packet.empty())
+        {
+            continue;
+        }
+
+        if (packet[0] == 'k')
+        {
+            Disconnect();
+            return;
+        }
+        std::string reply = Handle(packet, chip8);
+        if (!running)
+        {
+            Send(reply);
+        }
+        if (packet == "QStartNoAckMode")
+        {
+            noAck = true;
+        }
+        if (packet[0] == 'D')
+        {
+            Disconnect();
+            return;
+        }
+    }
+    input.erase(0, position);
+
+    if (running && debugger.Stopped())
+    {
+        running = false;
+        Send(StopReply());
+    }
+}
+#else
+GdbStub::GdbStub(const char *address, Debugger &debugger) : debugger(debugger)
+{
+    throw "GDB stub needs POSIX sockets";
+}
+
+GdbStub::~GdbStub() = default;
+
+void GdbStub::Poll(Chip8Base &chip8)
+{
+}
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include "chip8.hpp"
+#include "debugger.hpp"
+
+/** @brief GDB remote serial protocol server for one machine, listening on
+ *         localhost TCP when given a port number or on a Unix socket path
+ *         otherwise. Poll never blocks, so it is called from the main loop
+ *         between ticks and the machine keeps running until a client
+ *         stops it. The machine is stopped when a client attaches and is
+ *         let go with every breakpoint cleared when it detaches.
+ *
+ *  Registers, little endian: V0-VF 1 byte each (0-15), I 2 (16),
+ *  PC 2 (17), SP 1 (18), DT 1 (19), ST 1 (20). The same layout is sent
+ *  as target.xml through qXfer:features:read.
+ *  Memory packets and Z packets answer E01 past the memory of the profile.
+ *  Z0/Z1 set pc breakpoints, Z2/Z3/Z4 write/read/access watchpoints and
+ *  "monitor watch-reg N" / "monitor unwatch-reg N" watch register VN.
+ */
+class GdbStub
+{
+private:
+    Debugger &debugger;
+    int listenFd = -1;
+    int clientFd = -1;
+    std::string path;
+    std::string input;
+    bool noAck{};
+    // Client sent c or s and waits for stop reply
+    bool running{};
+
+    void Accept();
+    void Disconnect();
+    void Send(const std::string &payload);
+    std::string Handle(const std::string &packet, Chip8Base &chip8);
+    std::string StopReply() const;
+
+public:
+    GdbStub(const char *address, Debugger &debugger);
+    ~GdbStub();
+    GdbStub(const GdbStub &) = delete;
+    GdbStub &operator=(const GdbStub &) = delete;
+    void Poll(Chip8Base &chip8);
+};
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "chip8.hpp"
+#include "rompack.hpp"
+#include "snapshot.hpp"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+const unsigned int DEFAULT_BOOT_LIMIT = 1000000;
+const unsigned int DEFAULT_JOBS = 8;
+
+/// @brief One phase of a scenario, run ticks while holding keys
+struct ScenarioPhase
+{
+    unsigned int ticks;
+    uint16_t keys;
+};
+
+typedef std::vector<ScenarioPhase> Scenario;
+
+/** @brief Scenario file has one scenario per line made of phases written
+ *         as TICKSxKEYS, where KEYS is a hex bitmask of pressed keys.
+ *         "60x0 10x20 120x0" idles 60 ticks, holds key 5 for 10 and idles
+ */
+std::vector<Scenario> ReadScenarios(const char *filename)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        throw "Scenario file could not be opened";
+    }
+
+    std::vector<Scenario> scenarios;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        Scenario scenario;
+        std::istringstream phases(line);
+        std::string phase;
+        while (phases >> phase)
+        {
+            size_t separator = phase.find('x');
+            if (separator == std::string::npos)
+            {
+                throw "Scenario phase must look like TICKSxKEYS";
+            }
+            scenario.push_back({static_cast<unsigned int>(std::stoul(phase.substr(0, separator))),
+                                static_cast<uint16_t>(std::stoul(phase.substr(separator + 1), nullptr, 16))});
+        }
+        if (!scenario.empty())
+        {
+            scenarios.push_back(scenario);
+        }
+    }
+    return scenarios;
+}
+
+/// @brief Run scenario on given machine and print its outcome as one line
+void RunScenario(Chip8Base &chip8, const Scenario &scenario, unsigned int number, double spawnMicroseconds)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (const ScenarioPhase &phase : scenario)
+    {
+        for (unsigned int key = 0; key < KEYPAD_SIZE; ++key)
+        {
+            chip8.keypad[key] = (phase.keys >> key) & 0x1u;
+        }
+        for (unsigned int tick = 0; tick < phase.ticks; ++tick)
+        {
+            chip8.Tick();
+        }
+    }
+    double runMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    static Chip8State state;
+    chip8.GetState(state);
+
+    // Single write so lines of forked scenarios do not interleave
+    std::ostringstream line;
+    line << "scenario " << number << ": pc " << std::hex << state.pc
+         << " video " << HashROM(reinterpret_cast<const uint8_t *>(state.video), sizeof(state.video)) << std::dec
+         << " spawn " << spawnMicroseconds << "us run " << runMicroseconds << "us\n";
+    std::cout << line.str() << std::flush;
+}
+
+/** @brief Headless runner. Boots ROM once, optionally stores that point as
+ *         snapshot, then starts every scenario from it either by copying
+ *         the booted machine or by fork() so memory is shared copy-on-write.
+ *
+ *  usage: headless [options] (ROM | --load SNAPSHOT)
+ *    --profile NAME     quirk profile, as for main
+ *    --pack FILE        take ROM by name or hex hash from ROM pack, with its profile
+ *    --boot-ticks N     run N ticks before taking snapshot
+ *    --boot-pc ADDR     run until pc reaches hex ADDR before taking snapshot
+ *    --save FILE        store booted snapshot in FILE
+ *    --load FILE        start from snapshot FILE instead of ROM
+ *    --scenarios FILE   scenarios to run from snapshot
+ *    --fork             spawn scenarios with fork() instead of copying
+ *    --jobs N           forked scenarios running at once
+ */
+int main(int argc, char **argv)
+{
+    const char *romFilename = nullptr;
+    const char *saveFilename = nullptr;
+    const char *loadFilename = nullptr;
+    const char *scenarioFilename = nullptr;
+    const char *profileName = nullptr;
+    const char *packFilename = nullptr;
+    unsigned long bootTicks = 0;
+    long bootPc = -1;
+    bool useFork = false;
+    unsigned int jobs = DEFAULT_JOBS;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--profile") == 0 && hasValue)
+            profileName = argv[++i];
+        else if (std::strcmp(argv[i], "--pack") == 0 && hasValue)
+            packFilename = argv[++i];
+        else if (std::strcmp(argv[i], "--boot-ticks") == 0 && hasValue)
+            bootTicks = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--boot-pc") == 0 && hasValue)
+            bootPc = std::stol(argv[++i], nullptr, 16);
+        else if (std::strcmp(argv[i], "--save") == 0 && hasValue)
+            saveFilename = argv[++i];
+        else if (std::strcmp(argv[i], "--load") == 0 && hasValue)
+            loadFilename = argv[++i];
+        else if (std::strcmp(argv[i], "--scenarios") == 0 && hasValue)
+            scenarioFilename = argv[++i];
+        else if (std::strcmp(argv[i], "--fork") == 0)
+            useFork = true;
+        else if (std::strcmp(argv[i], "--jobs") == 0 && hasValue)
+            jobs = std::max(1ul, std::stoul(argv[++i]));
+        else
+            romFilename = argv[i];
+    }
+
+    if (!romFilename && !loadFilename)
+    {
+        std::cerr << "ERROR: Missing ROM or snapshot argument" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    static Chip8State state;
+    std::unique_ptr<Chip8Base> booted;
+    auto bootStart = std::chrono::steady_clock::now();
+
+    try
+    {
+        if (loadFilename)
+        {
+            booted = CreateChip8(LoadSnapshot(loadFilename, state));
+            booted->SetState(state);
+        }
+        else
+        {
+            QuirkProfile profile = QuirkProfile::Chip8;
+            if (profileName && !ParseQuirkProfile(profileName, profile))
+            {
+                std::cerr << "ERROR: Unknown quirk profile, expected chip8, vip, schip or xochip" << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+
+            if (packFilename)
+            {
+                RomPack pack(packFilename);
+                const RomPackEntry *entry = pack.Find(romFilename);
+                if (!entry)
+                {
+                    entry = pack.Find(std::strtoull(romFilename, nullptr, 16));
+                }
+                if (!entry)
+                {
+                    throw "ROM is not in ROM pack";
+                }
+                if (!profileName)
+                {
+                    profile = pack.Profile(*entry);
+                }
+                booted = CreateChip8(profile);
+                pack.Load(*entry, *booted);
+            }
+            else
+            {
+                booted = CreateChip8(profile);
+                booted->LoadROM(romFilename);
+            }
+
+            for (unsigned long tick = 0; tick < bootTicks; ++tick)
+            {
+                booted->Tick();
+            }
+            if (bootPc >= 0)
+            {
+                unsigned long tick = 0;
+                while (booted->PC() != bootPc)
+                {
+                    if (++tick > DEFAULT_BOOT_LIMIT)
+                    {
+                        std::cerr << "ERROR: Boot pc was not reached" << std::endl;
+                        std::exit(EXIT_FAILURE);
+                    }
+                    booted->Tick();
+                }
+            }
+
+            if (saveFilename)
+            {
+                booted->GetState(state);
+                SaveSnapshot(saveFilename, profile, state);
+            }
+        }
+    }
+    catch (const char *message)
+    {
+        std::cerr << "ERROR: " << message << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    double bootMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - bootStart).count();
+    std::cout << "LOG: booted in " << bootMicroseconds << "us" << std::endl;
+
+    if (!scenarioFilename)
+    {
+        return 0;
+    }
+
+    std::vector<Scenario> scenarios;
+    try
+    {
+        scenarios = ReadScenarios(scenarioFilename);
+    }
+    catch (const char *message)
+    {
+        std::cerr << "ERROR: " << message << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+#ifndef _WIN32
+    if (useFork)
+    {
+        unsigned int running = 0;
+        for (unsigned int i = 0; i < scenarios.size(); ++i)
+        {
+            if (running == jobs)
+            {
+                wait(nullptr);
+                --running;
+            }
+
+            auto spawnStart = std::chrono::steady_clock::now();
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                // Child sees booted machine copy-on-write
+                double spawnMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - spawnStart).count();
+                RunScenario(*booted, scenarios[i], i, spawnMicroseconds);
+                _exit(0);
+            }
+            if (pid < 0)
+            {
+                std::cerr << "ERROR: fork failed" << std::endl;
+                break;
+            }
+            ++running;
+        }
+        while (running > 0)
+        {
+            wait(nullptr);
+            --running;
+        }
+        return 0;
+    }
+#else
+    if (useFork)
+    {
+        std::cerr << "LOG: fork is not available, copying snapshot instead" << std::endl;
+    }
+#endif
+
+    for (unsigned int i = 0; i < scenarios.size(); ++i)
+    {
+        auto spawnStart = std::chrono::steady_clock::now();
+        std::unique_ptr<Chip8Base> chip8 = booted->Clone();
+        double spawnMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - spawnStart).count();
+        RunScenario(*chip8, scenarios[i], i, spawnMicroseconds);
+    }
+
+    return 0;
+}
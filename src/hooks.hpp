@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+
+/** @brief Platform hooks of freestanding builds. They are inline so the
+ *         interpreter is compiled with them in place. A platform replaces
+ *         them by building with -D CHIP8_HOOKS='"its_hooks.hpp"', a header
+ *         that defines the same namespace.
+ *
+ *  RandomState    whatever Cxkk needs between calls, kept in machine state
+ *  Entropy        random state a machine starts with
+ *  Seed           random state for Seed(seed), runs with equal seeds replay
+ *  RandomByte     next byte for Cxkk
+ *  Trace          every instruction before it runs, only with CHIP8_TRACE
+ *  UnknownOpcode  every instruction that matched no opcode
+ */
+namespace Chip8Hooks
+{
+    typedef uint32_t RandomState;
+
+    inline RandomState Entropy()
+    {
+        return 0x2545F491u;
+    }
+
+    inline RandomState Seed(unsigned int seed)
+    {
+        // xorshift never leaves 0
+        return seed ? seed : Entropy();
+    }
+
+    /// @brief xorshift32, top byte has the best bits
+    inline uint8_t RandomByte(RandomState &state)
+    {
+        state ^= state << 13u;
+        state ^= state >> 17u;
+        state ^= state << 5u;
+        return state >> 24u;
+    }
+
+    inline void Trace(uint16_t /* pc */, uint16_t /* opcode */)
+    {
+    }
+
+    inline void UnknownOpcode(uint16_t /* opcode */)
+    {
+    }
+}
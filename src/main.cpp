@@ -1,11 +1,34 @@
 #include <iostream>
 #include <stdio.h>
 #include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
 #include "chip8.hpp"
+#include "gdbstub.hpp"
+#include "metrics.hpp"
 #include "platform.hpp"
+#include "scaler.hpp"
+#include "snapshot.hpp"
+#include "watch.hpp"
 
 const unsigned int DEFAULT_VIDEO_SCALE = 10;
 const unsigned int DEFAULT_TICK_DELAY = 4;
+const char *DEFAULT_QUIRK_DATABASE = "quirks.db";
+
+/// @brief Read whole ROM file, false if it cannot be opened
+static bool ReadROM(const char *filename, std::vector<uint8_t> &image)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
 
 int main(int argc, char **argv)
 {
@@ -16,16 +39,140 @@ int main(int argc, char **argv)
         std::exit(EXIT_FAILURE);
     }
 
+    // Quirk profile is given explicitly or looked up by ROM hash
+    // --watch reloads ROM when it changes, --slot FILE keeps state across reloads and runs
+    // --gdb PORT|PATH runs debug interpreter with GDB stub on localhost port or Unix socket
+    // --filter nearest|scale2x, --scanlines PERCENT, --crt, --ghost PERCENT and
+    // --palette RRGGBB,... set up CPU scaling of frames
+    // --metrics PATH serves counters on Unix socket, %p in PATH becomes process id
+    QuirkProfile profile = SelectQuirkProfile(argv[1], DEFAULT_QUIRK_DATABASE);
+    bool watch = false;
+    const char *slotFilename = nullptr;
+    const char *gdbAddress = nullptr;
+    ScalerOptions scalerOptions;
+    const char *metricsAddress = nullptr;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--watch") == 0)
+        {
+            watch = true;
+        }
+        else if (std::strcmp(argv[i], "--slot") == 0 && i + 1 < argc)
+        {
+            slotFilename = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--gdb") == 0 && i + 1 < argc)
+        {
+            gdbAddress = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc)
+        {
+            metricsAddress = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            if (!ParseScaleFilter(argv[++i], scalerOptions.filter))
+            {
+                std::cerr << "ERROR: Unknown filter, expected nearest or scale2x" << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (std::strcmp(argv[i], "--scanlines") == 0 && i + 1 < argc)
+        {
+            scalerOptions.scanlines = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--crt") == 0)
+        {
+            scalerOptions.crtMask = true;
+        }
+        else if (std::strcmp(argv[i], "--ghost") == 0 && i + 1 < argc)
+        {
+            scalerOptions.ghosting = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--palette") == 0 && i + 1 < argc)
+        {
+            if (!ParsePalette(argv[++i], scalerOptions.palette))
+            {
+                std::cerr << "ERROR: Palette must be comma separated RRGGBB colors" << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (!ParseQuirkProfile(argv[i], profile))
+        {
+            std::cerr << "ERROR: Unknown quirk profile, expected chip8, vip, schip or xochip" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
     // Create Chip8 Machine
-    Platform platform("Chip8", VIDEO_WIDTH * DEFAULT_VIDEO_SCALE, VIDEO_HEIGHT * DEFAULT_VIDEO_SCALE, VIDEO_WIDTH, VIDEO_HEIGHT);
+    // Texture has window size, frames are scaled into it on the CPU
+    const unsigned int windowWidth = VIDEO_WIDTH * DEFAULT_VIDEO_SCALE;
+    const unsigned int windowHeight = VIDEO_HEIGHT * DEFAULT_VIDEO_SCALE;
+    Platform platform("Chip8", windowWidth, windowHeight, windowWidth, windowHeight);
     std::cout << "DEBUG: CREATED PLATFORM" << std::endl;
-    Chip8 chip8;
+    std::unique_ptr<Chip8Base> chip8 = gdbAddress ? CreateDebugChip8(profile) : CreateChip8(profile);
     std::cout << "DEBUG: CREATED CHIP8 INTERPRETER" << std::endl;
 
+    static Debugger debugger;
+    std::unique_ptr<GdbStub> gdbStub;
+    if (gdbAddress)
+    {
+        try
+        {
+            gdbStub = std::make_unique<GdbStub>(gdbAddress, debugger);
+            chip8->Attach(&debugger);
+            std::cout << "LOG: GDB stub listening on " << gdbAddress << std::endl;
+        }
+        catch (const char *message)
+        {
+            std::cout << message << std::endl;
+        }
+    }
+
+    std::unique_ptr<MetricsServer> metricsServer;
+    if (metricsAddress)
+    {
+        try
+        {
+            metricsServer = std::make_unique<MetricsServer>(metricsAddress, argv[1], 1000.0 / DEFAULT_TICK_DELAY);
+            std::cout << "LOG: Metrics served on " << metricsServer->Path() << std::endl;
+        }
+        catch (const char *message)
+        {
+            std::cout << message << std::endl;
+        }
+    }
+    MetricsSlot &metrics = ThreadMetrics();
+    uint32_t countedUnknownOpcodes = 0;
+    uint32_t countedInstructions = 0;
+
+    // Resume from slot saved by an earlier run of the same profile, ROM is then loaded over its program
+    static Chip8State slot;
+    if (slotFilename && std::ifstream(slotFilename).good())
+    {
+        try
+        {
+            if (LoadSnapshot(slotFilename, slot) == profile)
+            {
+                chip8->SetState(slot);
+                chip8->ClearProgram();
+                std::cout << "LOG: Resumed from slot" << std::endl;
+            }
+            else
+            {
+                std::cout << "ERROR: Slot was saved with another quirk profile, starting fresh" << std::endl;
+            }
+        }
+        catch (const char *message)
+        {
+            std::cout << message << std::endl;
+        }
+    }
+
     // Load ROM file
     try
     {
-        chip8.LoadROM(argv[1]);
+        chip8->LoadROM(argv[1]);
         std::cout << "LOG: Succesfully loaded file" << std::endl;
     }
     catch (const char *message)
@@ -33,15 +180,79 @@ int main(int argc, char **argv)
         std::cout << message << std::endl;
     }
 
+    std::unique_ptr<FileWatcher> watcher;
+    if (watch)
+    {
+        try
+        {
+            watcher = std::make_unique<FileWatcher>(argv[1]);
+            std::cout << "LOG: Watching ROM for changes" << std::endl;
+        }
+        catch (const char *message)
+        {
+            std::cout << message << std::endl;
+        }
+    }
+    std::vector<uint8_t> reloadImage;
+
     // Initialize Main Loop vars
-    int videoPitch = sizeof(chip8.video[0]) * VIDEO_WIDTH;
+    std::unique_ptr<Scaler> scaler = std::make_unique<Scaler>(windowWidth, windowHeight, scalerOptions);
     auto lastTick = std::chrono::high_resolution_clock::now();
     bool quit = false;
 
     // MAIN loop
     while (!quit)
     {
-        quit = platform.ProccessEvents(chip8.keypad);
+        {
+            MetricsTimer timer(metrics, Metric::EventNanoseconds);
+            quit = platform.ProccessEvents(chip8->keypad);
+        }
+        if (gdbStub)
+        {
+            gdbStub->Poll(*chip8);
+        }
+
+        // Reset same machine in place so window and renderer stay up. New image is
+        // read and checked first, a machine is only touched once it is known to fit
+        if (watcher && watcher->Changed())
+        {
+            auto reloadStart = std::chrono::high_resolution_clock::now();
+            if (!ReadROM(argv[1], reloadImage))
+            {
+                std::cout << "ERROR: ROM could not be read, keeping old one" << std::endl;
+            }
+            else if (reloadImage.size() > chip8->ProgramCapacity())
+            {
+                std::cout << "ERROR: ROM is too large, keeping old one" << std::endl;
+            }
+            else
+            {
+                // Old state stays with new program on top so game goes on near where it was
+                if (slotFilename)
+                {
+                    chip8->GetState(slot);
+                    try
+                    {
+                        SaveSnapshot(slotFilename, profile, slot);
+                    }
+                    catch (const char *message)
+                    {
+                        std::cout << message << std::endl;
+                    }
+                    chip8->ClearProgram();
+                }
+                else
+                {
+                    chip8->Reset();
+                    countedUnknownOpcodes = 0;
+                    countedInstructions = 0;
+                }
+                chip8->TryLoadROM(reloadImage.data(), reloadImage.size());
+
+                float reloadTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - reloadStart).count();
+                std::cout << "LOG: Reloaded ROM in " << reloadTime << "ms" << std::endl;
+            }
+        }
 
         auto currentTime = std::chrono::high_resolution_clock::now();
         float deltaTime = std::chrono::duration<float, std::chrono::milliseconds::period>(currentTime - lastTick).count();
@@ -49,9 +260,46 @@ int main(int argc, char **argv)
         if (deltaTime > DEFAULT_TICK_DELAY)
         {
             lastTick = currentTime;
-            chip8.Tick();
-            platform.Update(chip8.video, videoPitch);
+            {
+                MetricsTimer timer(metrics, Metric::TickNanoseconds);
+                chip8->Tick();
+            }
+            bool presented = false;
+            {
+                MetricsTimer timer(metrics, Metric::UpdateNanoseconds);
+                int pitch;
+                uint32_t *pixels = platform.Lock(pitch);
+                if (pixels)
+                {
+                    scaler->Render(*chip8, pixels, pitch);
+                    platform.Present();
+                    presented = true;
+                }
+            }
+
+            // Every interval that went by without a tick is a frame that was never shown
+            uint64_t missed = static_cast<uint64_t>(deltaTime / DEFAULT_TICK_DELAY) - 1;
+            metrics.Add(Metric::Instructions, chip8->Instructions() - countedInstructions);
+            countedInstructions = chip8->Instructions();
+            metrics.Add(Metric::FramesPresented, presented);
+            metrics.Add(Metric::FramesDropped, missed + !presented);
+            metrics.Add(Metric::UnknownOpcodes, chip8->UnknownOpcodes() - countedUnknownOpcodes);
+            countedUnknownOpcodes = chip8->UnknownOpcodes();
         };
     };
+
+    // Next run with the same slot goes on from here
+    if (slotFilename)
+    {
+        chip8->GetState(slot);
+        try
+        {
+            SaveSnapshot(slotFilename, profile, slot);
+        }
+        catch (const char *message)
+        {
+            std::cout << message << std::endl;
+        }
+    }
     return 0;
 }
\ No newline at end of file
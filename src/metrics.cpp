@@ -0,0 +1,209 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// How often the server thread looks whether it should stop
+const int METRICS_POLL_MILLISECONDS = 200;
+const size_t METRICS_REQUEST_SIZE = 1024;
+
+static MetricsSlot metricsSlots[METRICS_MAX_THREADS];
+static std::atomic<unsigned int> metricsSlotsUsed{0};
+
+/// @brief Slot of calling thread, claimed on first use and kept for the process lifetime
+MetricsSlot &ThreadMetrics()
+{
+    thread_local MetricsSlot *slot = nullptr;
+    if (!slot)
+    {
+        unsigned int claimed = metricsSlotsUsed.fetch_add(1, std::memory_order_relaxed);
+        if (claimed >= METRICS_MAX_THREADS - 1)
+        {
+            claimed = METRICS_MAX_THREADS - 1;
+            metricsSlots[claimed].shared.store(true, std::memory_order_relaxed);
+        }
+        slot = &metricsSlots[claimed];
+    }
+    return *slot;
+}
+
+/// @brief Sum of one counter over every thread
+uint64_t MetricsTotal(Metric metric)
+{
+    unsigned int used = std::min(metricsSlotsUsed.load(std::memory_order_relaxed), METRICS_MAX_THREADS);
+    uint64_t total = 0;
+    for (unsigned int i = 0; i < used; ++i)
+    {
+        total += metricsSlots[i].counters[static_cast<unsigned int>(metric)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/// @brief Quote label value the way the text format wants it
+static std::string LabelValue(const char *value)
+{
+    std::string quoted = "\"";
+    for (; *value; ++value)
+    {
+        if (*value == '\\' || *value == '"')
+            quoted += '\\';
+        if (*value == '\n')
+        {
+            quoted += "\\n";
+            continue;
+        }
+        quoted += *value;
+    }
+    return quoted + "\"";
+}
+
+/// @brief Append one metric with its help and type lines
+static void Sample(std::string &page, const char *name, const char *type, const char *help,
+                   const std::string &labels, double value)
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s{%s} %.17g\n",
+                  name, help, name, type, name, labels.c_str(), value);
+    page += line;
+}
+
+std::string MetricsServer::Page()
+{
+    auto now = std::chrono::steady_clock::now();
+    uint64_t instructions = MetricsTotal(Metric::Instructions);
+    double seconds = std::chrono::duration<double>(now - lastScrape).count();
+    double ips = seconds > 0 ? (instructions - lastInstructions) / seconds : 0;
+    lastInstructions = instructions;
+    lastScrape = now;
+
+    std::string page;
+    Sample(page, "chip8_instructions_total", "counter", "Instructions executed.",
+           labels, instructions);
+    Sample(page, "chip8_instructions_per_second", "gauge", "Instructions executed per second since previous scrape.",
+           labels, ips);
+    Sample(page, "chip8_target_instructions_per_second", "gauge", "Instructions per second the main loop aims for.",
+           labels, targetIps);
+    Sample(page, "chip8_frames_presented_total", "counter", "Frames drawn to the window.",
+           labels, MetricsTotal(Metric::FramesPresented));
+    Sample(page, "chip8_frames_dropped_total", "counter", "Frames the main loop was too late for.",
+           labels, MetricsTotal(Metric::FramesDropped));
+    Sample(page, "chip8_tick_seconds_total", "counter", "Time spent executing instructions.",
+           labels, MetricsTotal(Metric::TickNanoseconds) / 1e9);
+    Sample(page, "chip8_update_seconds_total", "counter", "Time spent drawing and presenting frames.",
+           labels, MetricsTotal(Metric::UpdateNanoseconds) / 1e9);
+    Sample(page, "chip8_events_seconds_total", "counter", "Time spent processing window and keyboard events.",
+           labels, MetricsTotal(Metric::EventNanoseconds) / 1e9);
+    Sample(page, "chip8_unknown_opcodes_total", "counter", "Instructions that matched no opcode.",
+           labels, MetricsTotal(Metric::UnknownOpcodes));
+    return page;
+}
+
+const std::string &MetricsServer::Path() const
+{
+    return path;
+}
+
+#ifndef _WIN32
+MetricsServer::MetricsServer(const char *address, const char *rom, double targetIps)
+    : targetIps(targetIps), lastScrape(std::chrono::steady_clock::now())
+{
+    for (; *address; ++address)
+    {
+        if (address[0] == '%' && address[1] == 'p')
+        {
+            path += std::to_string(getpid());
+            ++address;
+        }
+        else
+        {
+            path += *address;
+        }
+    }
+
+    sockaddr_un local{};
+    if (path.size() >= sizeof(local.sun_path))
+    {
+        throw "Metrics socket path is too long";
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    local.sun_family = AF_UNIX;
+    std::strcpy(local.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0)
+    {
+        if (listenFd >= 0)
+            close(listenFd);
+        throw "Metrics could not listen on socket";
+    }
+    listen(listenFd, 8);
+
+    labels = "pid=\"" + std::to_string(getpid()) + "\",rom=" + LabelValue(rom);
+    thread = std::thread(&MetricsServer::Serve, this);
+}
+
+MetricsServer::~MetricsServer()
+{
+    stopping = true;
+    thread.join();
+    close(listenFd);
+    unlink(path.c_str());
+}
+
+/// @brief Answer every connection with the current page until stopped
+void MetricsServer::Serve()
+{
+    pollfd waiting{listenFd, POLLIN, 0};
+    while (!stopping)
+    {
+        if (poll(&waiting, 1, METRICS_POLL_MILLISECONDS) <= 0)
+        {
+            continue;
+        }
+        int clientFd = accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0)
+        {
+            continue;
+        }
+
+        // Request itself does not matter, read what the client sent so closing does not reset it
+        pollfd request{clientFd, POLLIN, 0};
+        char buffer[METRICS_REQUEST_SIZE];
+        if (poll(&request, 1, METRICS_POLL_MILLISECONDS) > 0)
+        {
+            recv(clientFd, buffer, sizeof(buffer), 0);
+        }
+
+        std::string body = Page();
+        std::string response = "HTTP/1.0 200 OK\r\n"
+                               "Content-Type: text/plain; version=0.0.4\r\n"
+                               "Content-Length: " +
+                               std::to_string(body.size()) + "\r\n\r\n" + body;
+        for (size_t sent = 0; sent < response.size();)
+        {
+            ssize_t written = send(clientFd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0)
+                break;
+            sent += written;
+        }
+        close(clientFd);
+    }
+}
+#else
+MetricsServer::MetricsServer(const char *address, const char *rom, double targetIps) : targetIps(targetIps)
+{
+    throw "Metrics need POSIX sockets";
+}
+
+MetricsServer::~MetricsServer() = default;
+
+void MetricsServer::Serve()
+{
+}
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+const unsigned int METRICS_MAX_THREADS = 64;
+const size_t CACHE_LINE_SIZE = 64;
+
+enum class Metric
+{
+    Instructions,
+    UnknownOpcodes,
+    FramesPresented,
+    FramesDropped,
+    TickNanoseconds,
+    UpdateNanoseconds,
+    EventNanoseconds,
+    Count
+};
+
+const unsigned int METRIC_COUNT = static_cast<unsigned int>(Metric::Count);
+
+/** @brief Counters of one thread on cache lines of their own. Only that
+ *         thread writes them, so adding is a plain relaxed load and store
+ *         and scrapes from other threads never bounce the line while the
+ *         emulator runs. Once the other slots are taken every further
+ *         thread shares the last one, which falls back to atomic adds.
+ */
+struct alignas(CACHE_LINE_SIZE) MetricsSlot
+{
+    std::atomic<uint64_t> counters[METRIC_COUNT]{};
+    std::atomic<bool> shared{};
+
+    void Add(Metric metric, uint64_t amount)
+    {
+        std::atomic<uint64_t> &counter = counters[static_cast<unsigned int>(metric)];
+        if (shared.load(std::memory_order_relaxed))
+        {
+            counter.fetch_add(amount, std::memory_order_relaxed);
+        }
+        else
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+    }
+};
+
+MetricsSlot &ThreadMetrics();
+uint64_t MetricsTotal(Metric metric);
+
+/// @brief Adds time from construction to destruction to a nanosecond counter
+class MetricsTimer
+{
+private:
+    MetricsSlot &slot;
+    Metric metric;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    MetricsTimer(MetricsSlot &slot, Metric metric)
+        : slot(slot), metric(metric), start(std::chrono::steady_clock::now())
+    {
+    }
+    ~MetricsTimer()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        slot.Add(metric, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+};
+
+/** @brief Serves counters of every thread as Prometheus text over HTTP on a
+ *         Unix socket, e.g. curl --unix-socket PATH http://chip8/metrics.
+ *         A "%p" in the path becomes the process id so every instance on a
+ *         host gets its own socket. Connections are answered on a thread of
+ *         its own that only reads the counters.
+ */
+class MetricsServer
+{
+private:
+    int listenFd = -1;
+    std::string path;
+    std::string labels;
+    double targetIps;
+    std::atomic<bool> stopping{};
+    std::thread thread;
+
+    // Instructions at previous scrape, effective IPS is measured between scrapes
+    uint64_t lastInstructions{};
+    std::chrono::steady_clock::time_point lastScrape;
+
+    void Serve();
+    std::string Page();
+
+public:
+    MetricsServer(const char *address, const char *rom, double targetIps);
+    ~MetricsServer();
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+    const std::string &Path() const;
+};
@@ -0,0 +1,101 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "rompack.hpp"
+
+const char *DEFAULT_QUIRK_DATABASE = "quirks.db";
+const char *PROFILE_NAMES[] = {"chip8", "vip", "schip", "xochip"};
+
+/** @brief Build ROM pack from list file, or list contents of a pack.
+ *
+ *  usage: pack OUTPUT LIST   every LIST line is "ROM [profile [ticks]]",
+ *                            profile defaults to quirks.db lookup and
+ *                            ticks per frame to 0, left to the runner
+ *         pack PACK          print hash, profile, ticks, size and name
+ */
+int main(int argc, char **argv)
+{
+    if (argc == 2)
+    {
+        try
+        {
+            RomPack pack(argv[1]);
+            for (uint32_t i = 0; i < pack.Size(); ++i)
+            {
+                const RomPackEntry &entry = pack.Entry(i);
+                std::cout << std::hex << entry.hash << std::dec << " " << PROFILE_NAMES[static_cast<int>(pack.Profile(entry))]
+                          << " " << entry.ticksPerFrame << " " << entry.size << " " << pack.Name(entry) << std::endl;
+            }
+        }
+        catch (const char *message)
+        {
+            std::cerr << "ERROR: " << message << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        return 0;
+    }
+
+    if (argc != 3)
+    {
+        std::cerr << "ERROR: usage is pack OUTPUT LIST or pack PACK" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::ifstream list(argv[2]);
+    if (!list.is_open())
+    {
+        std::cerr << "ERROR: List file could not be opened" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<RomPackSource> sources;
+    std::string line;
+    while (std::getline(list, line))
+    {
+        std::istringstream fields(line);
+        std::string path;
+        std::string profileName;
+        unsigned int ticks = 0;
+        if (!(fields >> path))
+        {
+            continue;
+        }
+        fields >> profileName >> ticks;
+
+        RomPackSource source;
+        source.name = path.substr(path.find_last_of("/\\") + 1);
+        source.ticksPerFrame = ticks;
+        source.profile = SelectQuirkProfile(path.c_str(), DEFAULT_QUIRK_DATABASE);
+        if (!profileName.empty() && !ParseQuirkProfile(profileName.c_str(), source.profile))
+        {
+            std::cerr << "ERROR: Unknown quirk profile " << profileName << " for " << path << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        std::ifstream rom(path, std::ios::binary);
+        if (!rom.is_open())
+        {
+            std::cerr << "ERROR: " << path << " could not be opened" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        source.image.assign(std::istreambuf_iterator<char>(rom), std::istreambuf_iterator<char>());
+        sources.push_back(std::move(source));
+    }
+
+    try
+    {
+        WriteRomPack(argv[1], sources);
+        RomPack pack(argv[1]);
+        std::cout << "LOG: packed " << pack.Size() << " ROMs from " << sources.size() << " listed" << std::endl;
+    }
+    catch (const char *message)
+    {
+        std::cerr << "ERROR: " << message << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    return 0;
+}
@@ -5,6 +5,11 @@ Platform::Platform(char const *title, int width, int height, int textureWidth, i
     SDL_Init(SDL_INIT_VIDEO);
     window = SDL_CreateWindow(title, 0, 0, width, height, SDL_WINDOW_SHOWN);
     renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    // Machines without GPU still get a renderer, frames are already scaled on the CPU
+    if (!renderer)
+    {
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    }
     texture = SDL_CreateTexture(
         renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, textureWidth, textureHeight);
 };
@@ -17,10 +22,22 @@ Platform::~Platform()
     SDL_Quit();
 };
 
-void Platform::Update(void const *buffer, int pitch)
+/// @brief Texture pixels to draw next frame into, pitch is set to bytes per row.
+///        nullptr when texture could not be locked, then frame is skipped
+uint32_t *Platform::Lock(int &pitch)
+{
+    void *pixels;
+    if (SDL_LockTexture(texture, nullptr, &pixels, &pitch) != 0)
+    {
+        return nullptr;
+    }
+    return static_cast<uint32_t *>(pixels);
+};
+
+/// @brief Unlock texture filled after Lock and copy it to window as it is
+void Platform::Present()
 {
-    SDL_UpdateTexture(texture, nullptr, buffer, pitch);
-    SDL_RenderClear(renderer);
+    SDL_UnlockTexture(texture);
     SDL_RenderCopy(renderer, texture, nullptr, nullptr);
     SDL_RenderPresent(renderer);
 };
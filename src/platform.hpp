@@ -12,6 +12,7 @@ private:
 public:
     Platform(char const *title, int width, int height, int textureWidth, int textureHeight);
     ~Platform();
-    void Update(void const *buffer, int pitch);
+    uint32_t *Lock(int &pitch);
+    void Present();
     bool ProccessEvents(uint8_t *keys);
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "quirks.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+const uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325u;
+const uint64_t FNV_PRIME = 0x100000001B3u;
+
+/// @brief Translate profile name as used on command line and in database
+bool ParseQuirkProfile(const char *name, QuirkProfile &profile)
+{
+    if (std::strcmp(name, "chip8") == 0)
+    {
+        profile = QuirkProfile::Chip8;
+    }
+    else if (std::strcmp(name, "vip") == 0)
+    {
+        profile = QuirkProfile::CosmacVIP;
+    }
+    else if (std::strcmp(name, "schip") == 0)
+    {
+        profile = QuirkProfile::SuperChip;
+    }
+    else if (std::strcmp(name, "xochip") == 0)
+    {
+        profile = QuirkProfile::XOChip;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+};
+
+/// @brief Bytes of memory a machine of given profile addresses
+unsigned int ProfileMemorySize(QuirkProfile profile)
+{
+    switch (profile)
+    {
+    case QuirkProfile::CosmacVIP:
+        return QuirksCosmacVIP::memorySize;
+    case QuirkProfile::SuperChip:
+        return QuirksSuperChip::memorySize;
+    case QuirkProfile::XOChip:
+        return QuirksXOChip::memorySize;
+    default:
+        return QuirksChip8::memorySize;
+    }
+};
+
+/// @brief 64 bit FNV-1a hash of ROM contents
+uint64_t HashROM(const uint8_t *data, size_t size)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+};
+
+/** @brief Look ROM up in quirk database. Every database line holds ROM hash
+ *         in hex and profile name, e.g. "a1b2c3d4e5f60718 schip". ROMs that
+ *         are not listed or cannot be read run with the Chip8 profile.
+ */
+QuirkProfile SelectQuirkProfile(const char *romFilename, const char *databaseFilename)
+{
+    QuirkProfile profile = QuirkProfile::Chip8;
+
+    std::ifstream rom(romFilename, std::ios::binary);
+    std::ifstream database(databaseFilename);
+    if (!rom.is_open() || !database.is_open())
+    {
+        return profile;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(rom)), std::istreambuf_iterator<char>());
+    uint64_t hash = HashROM(data.data(), data.size());
+
+    std::string name;
+    uint64_t entry;
+    while (database >> std::hex >> entry >> name)
+    {
+        if (entry == hash)
+        {
+            ParseQuirkProfile(name.c_str(), profile);
+            break;
+        }
+    }
+
+    return profile;
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/** @brief Quirk profiles select how ambiguous opcodes behave. Each one is a
+ *         set of constexpr flags Chip8 is instantiated with, so a profile
+ *         compiles to its own interpreter without runtime checks.
+ *
+ *  shiftReadsVy             8xy6/8xyE shift Vy into Vx instead of Vx in place
+ *  loadStoreIncrementsIndex Fx55/Fx65 leave Index at Index + x + 1
+ *  jumpUsesVx               Bxnn jumps to xnn + Vx instead of nnn + V0
+ *  spritesWrap              Dxyn wraps pixels past the edge instead of clipping them
+ *  logicResetsVF            8xy1/8xy2/8xy3 set VF to 0
+ *  superChip                hi-res mode, scrolling, 16x16 sprites, big font and flags
+ *  xoChip                   bitplanes, 64 KB memory, F000 nnnn, 5xy2/5xy3 and audio
+ *  memorySize               bytes of memory the ROM can address
+ *  debug                    execution loop calls debugger hooks, see Debugged
+ */
+
+/// @brief Behaviour this interpreter always had
+struct QuirksChip8
+{
+    static constexpr bool shiftReadsVy = false;
+    static constexpr bool loadStoreIncrementsIndex = false;
+    static constexpr bool jumpUsesVx = false;
+    static constexpr bool spritesWrap = true;
+    static constexpr bool logicResetsVF = false;
+    static constexpr bool superChip = false;
+    static constexpr bool xoChip = false;
+    static constexpr unsigned int memorySize = 0x1000;
+    static constexpr bool debug = false;
+};
+
+/// @brief Original COSMAC VIP interpreter
+struct QuirksCosmacVIP
+{
+    static constexpr bool shiftReadsVy = true;
+    static constexpr bool loadStoreIncrementsIndex = true;
+    static constexpr bool jumpUsesVx = false;
+    static constexpr bool spritesWrap = false;
+    static constexpr bool logicResetsVF = true;
+    static constexpr bool superChip = false;
+    static constexpr bool xoChip = false;
+    static constexpr unsigned int memorySize = 0x1000;
+    static constexpr bool debug = false;
+};
+
+/// @brief SUPER-CHIP 1.1 on the HP48
+struct QuirksSuperChip
+{
+    static constexpr bool shiftReadsVy = false;
+    static constexpr bool loadStoreIncrementsIndex = false;
+    static constexpr bool jumpUsesVx = true;
+    static constexpr bool spritesWrap = false;
+    static constexpr bool logicResetsVF = false;
+    static constexpr bool superChip = true;
+    static constexpr bool xoChip = false;
+    static constexpr unsigned int memorySize = 0x1000;
+    static constexpr bool debug = false;
+};
+
+/// @brief XO-CHIP as implemented by Octo
+struct QuirksXOChip
+{
+    static constexpr bool shiftReadsVy = true;
+    static constexpr bool loadStoreIncrementsIndex = true;
+    static constexpr bool jumpUsesVx = false;
+    static constexpr bool spritesWrap = true;
+    static constexpr bool logicResetsVF = false;
+    static constexpr bool superChip = true;
+    static constexpr bool xoChip = true;
+    static constexpr unsigned int memorySize = 0x10000;
+    static constexpr bool debug = false;
+};
+
+/** @brief Any profile with debugger hooks compiled into the execution loop.
+ *         Profiles without it never check for breakpoints or watchpoints
+ */
+template <typename Quirks>
+struct Debugged : Quirks
+{
+    static constexpr bool debug = true;
+};
+
+enum class QuirkProfile
+{
+    Chip8,
+    CosmacVIP,
+    SuperChip,
+    XOChip
+};
+
+bool ParseQuirkProfile(const char *name, QuirkProfile &profile);
+unsigned int ProfileMemorySize(QuirkProfile profile);
+uint64_t HashROM(const uint8_t *data, size_t size);
+QuirkProfile SelectQuirkProfile(const char *romFilename, const char *databaseFilename);
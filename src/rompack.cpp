@@ -0,0 +1,267 @@
+#include "rompack.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const char ROM_PACK_MAGIC[4] = {'C', '8', 'R', 'P'};
+const uint32_t ROM_PACK_VERSION = 1;
+
+/** @brief Write sources as ROM pack. A ROM listed more than once is stored
+ *         once with the metadata of its first listing
+ */
+void WriteRomPack(const char *filename, const std::vector<RomPackSource> &sources)
+{
+    std::vector<const RomPackSource *> unique;
+    std::vector<RomPackEntry> entries;
+    std::unordered_set<uint64_t> listed;
+    for (const RomPackSource &source : sources)
+    {
+        uint64_t hash = HashROM(source.image.data(), source.image.size());
+        if (listed.insert(hash).second)
+        {
+            RomPackEntry entry{};
+            entry.hash = hash;
+            entries.push_back(entry);
+            unique.push_back(&source);
+        }
+    }
+
+    uint32_t count = entries.size();
+    uint64_t namesOffset = sizeof(RomPackHeader) + count * (sizeof(RomPackEntry) + sizeof(RomPackNameIndex));
+    uint64_t namesSize = 0;
+    uint64_t imagesSize = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        entries[i].nameOffset = namesSize;
+        entries[i].nameLength = unique[i]->name.size();
+        entries[i].offset = imagesSize;
+        entries[i].size = unique[i]->image.size();
+        entries[i].ticksPerFrame = unique[i]->ticksPerFrame;
+        entries[i].profile = static_cast<uint8_t>(unique[i]->profile);
+        namesSize += unique[i]->name.size();
+        imagesSize += unique[i]->image.size();
+    }
+    uint64_t imagesOffset = namesOffset + namesSize;
+    for (RomPackEntry &entry : entries)
+    {
+        entry.offset += imagesOffset;
+    }
+
+    // Names and images stay in listing order, only the indices are sorted
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&entries](uint32_t a, uint32_t b)
+              { return entries[a].hash < entries[b].hash; });
+
+    std::vector<RomPackEntry> sorted;
+    std::vector<RomPackNameIndex> names;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        sorted.push_back(entries[order[i]]);
+        const std::string &name = unique[order[i]]->name;
+        RomPackNameIndex index{};
+        index.nameHash = HashROM(reinterpret_cast<const uint8_t *>(name.data()), name.size());
+        index.entry = i;
+        names.push_back(index);
+    }
+    std::sort(names.begin(), names.end(), [](const RomPackNameIndex &a, const RomPackNameIndex &b)
+              { return a.nameHash < b.nameHash; });
+
+    RomPackHeader header{};
+    std::memcpy(header.magic, ROM_PACK_MAGIC, sizeof(header.magic));
+    header.version = ROM_PACK_VERSION;
+    header.entryCount = count;
+    header.namesOffset = namesOffset;
+    header.imagesOffset = imagesOffset;
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw "ROM pack could not be created";
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(sorted.data()), count * sizeof(RomPackEntry));
+    file.write(reinterpret_cast<const char *>(names.data()), count * sizeof(RomPackNameIndex));
+    for (const RomPackSource *source : unique)
+    {
+        file.write(source->name.data(), source->name.size());
+    }
+    for (const RomPackSource *source : unique)
+    {
+        file.write(reinterpret_cast<const char *>(source->image.data()), source->image.size());
+    }
+    if (!file)
+    {
+        throw "ROM pack could not be written";
+    }
+};
+
+/// @brief Map ROM pack and check its header and indices fit in the file
+RomPack::RomPack(const char *filename)
+{
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        throw "ROM pack could not be opened";
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        throw "ROM pack is truncated";
+    }
+    size = info.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw "ROM pack could not be mapped";
+    }
+    data = static_cast<const uint8_t *>(mapping);
+#else
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw "ROM pack could not be opened";
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = contents.data();
+    size = contents.size();
+#endif
+
+    header = reinterpret_cast<const RomPackHeader *>(data);
+    if (size < sizeof(RomPackHeader) || std::memcmp(header->magic, ROM_PACK_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != ROM_PACK_VERSION)
+    {
+        Unmap();
+        throw "ROM pack is not compatible with this build";
+    }
+
+    uint64_t indexEnd = sizeof(RomPackHeader) + uint64_t(header->entryCount) * (sizeof(RomPackEntry) + sizeof(RomPackNameIndex));
+    if (indexEnd > size || header->namesOffset < indexEnd || header->namesOffset > header->imagesOffset ||
+        header->imagesOffset > size)
+    {
+        Unmap();
+        throw "ROM pack is truncated";
+    }
+
+    entries = reinterpret_cast<const RomPackEntry *>(data + sizeof(RomPackHeader));
+    names = reinterpret_cast<const RomPackNameIndex *>(entries + header->entryCount);
+}
+
+RomPack::~RomPack()
+{
+    Unmap();
+}
+
+void RomPack::Unmap()
+{
+#ifndef _WIN32
+    if (data)
+    {
+        munmap(const_cast<uint8_t *>(data), size);
+    }
+#endif
+    data = nullptr;
+}
+
+uint32_t RomPack::Size() const
+{
+    return header->entryCount;
+}
+
+/// @brief Entry by position, entries are ordered by ROM hash
+const RomPackEntry &RomPack::Entry(uint32_t number) const
+{
+    if (number >= header->entryCount)
+    {
+        throw "ROM pack entry does not exist";
+    }
+    return entries[number];
+}
+
+/// @brief Entry of ROM with given content hash or nullptr
+const RomPackEntry *RomPack::Find(uint64_t hash) const
+{
+    const RomPackEntry *end = entries + header->entryCount;
+    const RomPackEntry *entry = std::lower_bound(entries, end, hash, [](const RomPackEntry &entry, uint64_t hash)
+                                                 { return entry.hash < hash; });
+    return entry != end && entry->hash == hash ? entry : nullptr;
+}
+
+/// @brief Entry of ROM with given name or nullptr
+const RomPackEntry *RomPack::Find(const char *name) const
+{
+    size_t length = std::strlen(name);
+    uint64_t nameHash = HashROM(reinterpret_cast<const uint8_t *>(name), length);
+    const RomPackNameIndex *end = names + header->entryCount;
+    const RomPackNameIndex *index = std::lower_bound(names, end, nameHash, [](const RomPackNameIndex &index, uint64_t hash)
+                                                     { return index.nameHash < hash; });
+
+    // Names sharing a hash sit next to each other
+    for (; index != end && index->nameHash == nameHash; ++index)
+    {
+        const RomPackEntry &entry = Entry(index->entry);
+        if (Name(entry) == std::string(name, length))
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+std::string RomPack::Name(const RomPackEntry &entry) const
+{
+    if (header->namesOffset + entry.nameOffset + entry.nameLength > header->imagesOffset)
+    {
+        throw "ROM pack entry is out of bounds";
+    }
+    return std::string(reinterpret_cast<const char *>(data + header->namesOffset + entry.nameOffset), entry.nameLength);
+}
+
+/// @brief ROM contents inside the mapping, valid as long as pack lives
+const uint8_t *RomPack::Image(const RomPackEntry &entry) const
+{
+    // Compared without adding so a huge offset cannot wrap around into range
+    if (entry.offset < header->imagesOffset || entry.offset > size || entry.size > size - entry.offset)
+    {
+        throw "ROM pack entry is out of bounds";
+    }
+    return data + entry.offset;
+}
+
+QuirkProfile RomPack::Profile(const RomPackEntry &entry) const
+{
+    if (entry.profile > static_cast<uint8_t>(QuirkProfile::XOChip))
+    {
+        throw "ROM pack entry has unknown quirk profile";
+    }
+    return static_cast<QuirkProfile>(entry.profile);
+}
+
+/// @brief Copy ROM straight from the mapping into machine memory
+void RomPack::Load(const RomPackEntry &entry, Chip8Base &chip8) const
+{
+    chip8.LoadROM(Image(entry), entry.size);
+}
+
+/// @brief Fresh interpreter for the entry's quirk profile with its ROM loaded
+std::unique_ptr<Chip8Base> RomPack::Create(const RomPackEntry &entry) const
+{
+    std::unique_ptr<Chip8Base> chip8 = CreateChip8(Profile(entry));
+    Load(entry, *chip8);
+    return chip8;
+}
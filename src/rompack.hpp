@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "chip8.hpp"
+
+/** @brief ROM pack is one file holding a whole catalog of ROMs:
+ *
+ *    RomPackHeader
+ *    RomPackEntry[entryCount]      sorted by ROM hash
+ *    RomPackNameIndex[entryCount]  sorted by hash of name
+ *    names                         concatenated, not terminated
+ *    images                        concatenated ROM contents
+ *
+ *  Hashes are HashROM of ROM contents and of name. Every entry carries
+ *  the quirk profile and ticks per frame the ROM should run with.
+ */
+struct RomPackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t namesOffset;
+    uint64_t imagesOffset;
+};
+
+struct RomPackEntry
+{
+    uint64_t hash;
+    uint64_t offset;
+    uint32_t size;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    // 0 leaves ticks per frame to the runner
+    uint16_t ticksPerFrame;
+    uint8_t profile;
+    uint8_t reserved;
+};
+
+struct RomPackNameIndex
+{
+    uint64_t nameHash;
+    uint32_t entry;
+    uint32_t reserved;
+};
+
+/// @brief ROM and its metadata as handed to WriteRomPack
+struct RomPackSource
+{
+    std::string name;
+    std::vector<uint8_t> image;
+    QuirkProfile profile;
+    uint16_t ticksPerFrame;
+};
+
+void WriteRomPack(const char *filename, const std::vector<RomPackSource> &sources);
+
+/** @brief Read only view of a ROM pack mapped into memory once. Looking a
+ *         ROM up is a binary search over the index and loading it is a
+ *         single copy from the mapping into machine memory.
+ */
+class RomPack
+{
+private:
+    const uint8_t *data{};
+    size_t size{};
+    const RomPackHeader *header{};
+    const RomPackEntry *entries{};
+    const RomPackNameIndex *names{};
+#ifdef _WIN32
+    std::vector<uint8_t> contents;
+#endif
+    void Unmap();
+
+public:
+    RomPack(const char *filename);
+    ~RomPack();
+    RomPack(const RomPack &) = delete;
+    RomPack &operator=(const RomPack &) = delete;
+
+    uint32_t Size() const;
+    const RomPackEntry &Entry(uint32_t number) const;
+    const RomPackEntry *Find(uint64_t hash) const;
+    const RomPackEntry *Find(const char *name) const;
+    std::string Name(const RomPackEntry &entry) const;
+    const uint8_t *Image(const RomPackEntry &entry) const;
+    QuirkProfile Profile(const RomPackEntry &entry) const;
+    void Load(const RomPackEntry &entry, Chip8Base &chip8) const;
+    std::unique_ptr<Chip8Base> Create(const RomPackEntry &entry) const;
+};
@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "rompack.hpp"
+
+const char *TEST_PACK_FILENAME = "rompack_test.c8p";
+
+/// @brief Pack with one entry whose image offset and size are overwritten
+static void WriteEntry(uint64_t offset, uint32_t size)
+{
+    RomPackSource source{"TEST", {0x12, 0x00}, QuirkProfile::Chip8, 0};
+    WriteRomPack(TEST_PACK_FILENAME, {source});
+
+    std::fstream file(TEST_PACK_FILENAME, std::ios::binary | std::ios::in | std::ios::out);
+    RomPackEntry entry;
+    file.seekg(sizeof(RomPackHeader));
+    file.read(reinterpret_cast<char *>(&entry), sizeof(entry));
+    entry.offset = offset;
+    entry.size = size;
+    file.seekp(sizeof(RomPackHeader));
+    file.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+}
+
+/// @brief True when Image refuses the entry of the pack on disk
+static bool ImageRejected()
+{
+    RomPack pack(TEST_PACK_FILENAME);
+    try
+    {
+        pack.Image(pack.Entry(0));
+    }
+    catch (const char *)
+    {
+        return true;
+    }
+    return false;
+}
+
+/** @brief Checks that ROM pack entries pointing outside the file are
+ *         refused before anything is read through them
+ *
+ *  usage: rompack_test
+ */
+int main()
+{
+    int failures = 0;
+    auto Check = [&failures](bool passed, const char *name)
+    {
+        std::cout << (passed ? "LOG: passed " : "ERROR: failed ") << name << std::endl;
+        failures += !passed;
+    };
+
+    // Offset that wraps to a small number when size is added to it
+    WriteEntry(UINT64_MAX - 1, 2);
+    Check(ImageRejected(), "offset near UINT64_MAX");
+
+    WriteEntry(UINT64_MAX / 2, 2);
+    Check(ImageRejected(), "offset past end of file");
+
+    std::ifstream file(TEST_PACK_FILENAME, std::ios::binary | std::ios::ate);
+    uint64_t fileSize = file.tellg();
+    WriteEntry(fileSize - 1, 2);
+    Check(ImageRejected(), "image running past end of file");
+
+    WriteEntry(0, 2);
+    Check(ImageRejected(), "image inside header");
+
+    WriteEntry(fileSize - 2, 2);
+    Check(!ImageRejected(), "image at end of file");
+
+    std::remove(TEST_PACK_FILENAME);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
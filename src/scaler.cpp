@@ -0,0 +1,300 @@
+#include "scaler.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Multipliers out of 256 for the dimmed channels of the CRT mask
+const uint16_t CRT_MASK_DIM = 170;
+const uint16_t FULL_FACTOR = 256;
+
+/// @brief Translate filter name as used on command line
+bool ParseScaleFilter(const char *name, ScaleFilter &filter)
+{
+    if (std::strcmp(name, "nearest") == 0)
+    {
+        filter = ScaleFilter::Nearest;
+    }
+    else if (std::strcmp(name, "scale2x") == 0 || std::strcmp(name, "epx") == 0)
+    {
+        filter = ScaleFilter::Scale2x;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+};
+
+/** @brief Parse comma separated RRGGBB colours, background first. Colours
+ *         that are not given keep their current value
+ */
+bool ParsePalette(const char *colors, uint32_t *palette)
+{
+    for (unsigned int i = 0; i < (1u << VIDEO_PLANES) && *colors; ++i)
+    {
+        char *end;
+        unsigned long color = std::strtoul(colors, &end, 16);
+        if (end - colors != 6 || (*end && *end != ','))
+        {
+            return false;
+        }
+        palette[i] = (color << 8u) | 0xFFu;
+        colors = *end ? end + 1 : end;
+    }
+    return true;
+};
+
+/// @brief Write color count times
+static void FillPixels(uint32_t *out, uint32_t color, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef __SSE2__
+    __m128i colors = _mm_set1_epi32(color);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), colors);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = color;
+    }
+}
+
+/// @brief Multiply every byte by its factor out of 256
+static void MultiplyPixels(const uint32_t *in, const uint16_t *factors, uint32_t *out, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        __m128i low = _mm_unpacklo_epi8(pixels, zero);
+        __m128i high = _mm_unpackhi_epi8(pixels, zero);
+        low = _mm_mullo_epi16(low, _mm_loadu_si128(reinterpret_cast<const __m128i *>(factors + 4 * i)));
+        high = _mm_mullo_epi16(high, _mm_loadu_si128(reinterpret_cast<const __m128i *>(factors + 4 * i + 8)));
+        pixels = _mm_packus_epi16(_mm_srli_epi16(low, 8), _mm_srli_epi16(high, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), pixels);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(in + i);
+        uint8_t *result = reinterpret_cast<uint8_t *>(out + i);
+        for (unsigned int b = 0; b < 4; ++b)
+        {
+            result[b] = (bytes[b] * factors[4 * i + b]) >> 8u;
+        }
+    }
+}
+
+/// @brief Fade ghost by keep out of 256 and raise it to image wherever image is brighter
+static void DecayMax(uint32_t *ghost, const uint32_t *image, unsigned int count, uint16_t keep)
+{
+    unsigned int i = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    __m128i factor = _mm_set1_epi16(keep);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ghost + i));
+        __m128i low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(old, zero), factor), 8);
+        __m128i high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(old, zero), factor), 8);
+        __m128i faded = _mm_packus_epi16(low, high);
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i *>(image + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(ghost + i), _mm_max_epu8(faded, current));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(ghost + i);
+        const uint8_t *current = reinterpret_cast<const uint8_t *>(image + i);
+        for (unsigned int b = 0; b < 4; ++b)
+        {
+            bytes[b] = std::max<uint8_t>((bytes[b] * keep) >> 8u, current[b]);
+        }
+    }
+}
+
+/** @brief Palette colour of every pixel of one framebuffer row. Four pixels
+ *         at a time take their bits from both planes, spread them over four
+ *         lanes and pick the colour with masks from comparing them
+ */
+static void ExpandRow(VideoRow first, VideoRow second, const uint32_t *palette, uint32_t *out, unsigned int width)
+{
+    unsigned int x = 0;
+#ifdef __SSE2__
+    // Leftmost pixel of a group is the highest of its four bits
+    const __m128i bits = _mm_set_epi32(1, 2, 4, 8);
+    const __m128i colors[4] = {_mm_set1_epi32(palette[0]), _mm_set1_epi32(palette[1]),
+                               _mm_set1_epi32(palette[2]), _mm_set1_epi32(palette[3])};
+    for (; x + 4 <= width; x += 4)
+    {
+        unsigned int shift = HIRES_VIDEO_WIDTH - 4 - x;
+        __m128i low = _mm_set1_epi32(static_cast<int>((first >> shift) & 0xFu));
+        __m128i high = _mm_set1_epi32(static_cast<int>((second >> shift) & 0xFu));
+        __m128i lowSet = _mm_cmpeq_epi32(_mm_and_si128(low, bits), bits);
+        __m128i highSet = _mm_cmpeq_epi32(_mm_and_si128(high, bits), bits);
+
+        __m128i pixels = _mm_andnot_si128(_mm_or_si128(lowSet, highSet), colors[0]);
+        pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_andnot_si128(highSet, lowSet), colors[1]));
+        pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_andnot_si128(lowSet, highSet), colors[2]));
+        pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_and_si128(lowSet, highSet), colors[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), pixels);
+    }
+#endif
+    for (; x < width; ++x)
+    {
+        unsigned int bit = HIRES_VIDEO_WIDTH - 1 - x;
+        unsigned int color = ((first >> bit) & 0x1u) | (((second >> bit) & 0x1u) << 1);
+        out[x] = palette[color];
+    }
+}
+
+/** @brief Prepare row buffers and multipliers for output size. Alpha, the
+ *         lowest byte of RGBA8888 in memory, is never scaled
+ */
+Scaler::Scaler(unsigned int width, unsigned int height, const ScalerOptions &options)
+    : options(options), width(width), height(height),
+      row(width), maskedRow(width), shadedRow(width),
+      maskFactors(width * 4), shadeFactors(width * 4)
+{
+    uint16_t shade = FULL_FACTOR * (100 - std::min(options.scanlines, 100u)) / 100;
+    for (unsigned int x = 0; x < width; ++x)
+    {
+        // Bytes in memory are alpha, blue, green, red
+        for (unsigned int b = 0; b < 4; ++b)
+        {
+            bool lit = b == 0 || !options.crtMask || b == 3 - x % 3;
+            maskFactors[4 * x + b] = lit ? FULL_FACTOR : CRT_MASK_DIM;
+            shadeFactors[4 * x + b] = b == 0 ? FULL_FACTOR : maskFactors[4 * x + b] * shade / FULL_FACTOR;
+        }
+    }
+}
+
+/** @brief EPX on source colours into doubled. Each pixel becomes four and
+ *         a corner takes the colour of its two neighbours when they agree
+ */
+void Scaler::Scale2x(unsigned int sourceWidth, unsigned int sourceHeight)
+{
+    unsigned int doubledWidth = sourceWidth * 2;
+    for (unsigned int y = 0; y < sourceHeight; ++y)
+    {
+        const uint32_t *line = source + y * sourceWidth;
+        const uint32_t *above = y > 0 ? line - sourceWidth : line;
+        const uint32_t *below = y + 1 < sourceHeight ? line + sourceWidth : line;
+        uint32_t *top = doubled + 2 * y * doubledWidth;
+        uint32_t *bottom = top + doubledWidth;
+
+        for (unsigned int x = 0; x < sourceWidth; ++x)
+        {
+            uint32_t p = line[x];
+            uint32_t a = above[x];
+            uint32_t d = below[x];
+            uint32_t c = x > 0 ? line[x - 1] : p;
+            uint32_t b = x + 1 < sourceWidth ? line[x + 1] : p;
+
+            bool smooth = a != d && c != b;
+            top[2 * x] = smooth && c == a ? a : p;
+            top[2 * x + 1] = smooth && a == b ? b : p;
+            bottom[2 * x] = smooth && d == c ? c : p;
+            bottom[2 * x + 1] = smooth && b == d ? d : p;
+        }
+    }
+}
+
+/// @brief Blend image with what was shown before, restarting when its size changes
+void Scaler::Ghost(uint32_t *image, unsigned int imageWidth, unsigned int imageHeight)
+{
+    unsigned int count = imageWidth * imageHeight;
+    if (imageWidth != ghostWidth || imageHeight != ghostHeight)
+    {
+        std::memcpy(ghost, image, count * sizeof(uint32_t));
+        ghostWidth = imageWidth;
+        ghostHeight = imageHeight;
+    }
+    DecayMax(ghost, image, count, FULL_FACTOR * std::min(options.ghosting, 100u) / 100);
+    std::memcpy(image, ghost, count * sizeof(uint32_t));
+}
+
+/// @brief Draw machine framebuffer into pixels, pitch is in bytes as SDL_LockTexture gives it
+void Scaler::Render(const Chip8Base &chip8, uint32_t *pixels, int pitch)
+{
+    // Lo-res machines are scaled from their own 64x32 pixels
+    unsigned int sourceWidth = chip8.Hires() ? HIRES_VIDEO_WIDTH : VIDEO_WIDTH;
+    unsigned int sourceHeight = chip8.Hires() ? HIRES_VIDEO_HEIGHT : VIDEO_HEIGHT;
+    for (unsigned int y = 0; y < sourceHeight; ++y)
+    {
+        ExpandRow(chip8.video[0][y], chip8.video[1][y], options.palette, source + y * sourceWidth, sourceWidth);
+    }
+
+    uint32_t *image = source;
+    unsigned int imageWidth = sourceWidth;
+    unsigned int imageHeight = sourceHeight;
+    if (options.filter == ScaleFilter::Scale2x)
+    {
+        Scale2x(sourceWidth, sourceHeight);
+        image = doubled;
+        imageWidth *= 2;
+        imageHeight *= 2;
+    }
+    if (options.ghosting)
+    {
+        Ghost(image, imageWidth, imageHeight);
+    }
+
+    // Largest whole factor that fits, centred with background coloured borders
+    unsigned int scale = std::max(1u, std::min(width / imageWidth, height / imageHeight));
+    unsigned int drawnWidth = std::min(width, imageWidth * scale);
+    unsigned int drawnHeight = std::min(height, imageHeight * scale);
+    unsigned int left = (width - drawnWidth) / 2;
+    unsigned int top = (height - drawnHeight) / 2;
+    uint32_t border = options.palette[0];
+    bool shaded = options.scanlines && scale > 1;
+
+    auto Line = [pixels, pitch](unsigned int y)
+    {
+        return reinterpret_cast<uint32_t *>(reinterpret_cast<uint8_t *>(pixels) + y * pitch);
+    };
+
+    FillPixels(row.data(), border, width);
+    for (unsigned int y = 0; y < top; ++y)
+    {
+        std::memcpy(Line(y), row.data(), width * sizeof(uint32_t));
+    }
+    for (unsigned int y = top + drawnHeight; y < height; ++y)
+    {
+        std::memcpy(Line(y), row.data(), width * sizeof(uint32_t));
+    }
+
+    for (unsigned int y = 0; y < imageHeight && y * scale < drawnHeight; ++y)
+    {
+        const uint32_t *imageRow = image + y * imageWidth;
+        for (unsigned int x = 0; x < imageWidth && x * scale < drawnWidth; ++x)
+        {
+            FillPixels(row.data() + left + x * scale, imageRow[x], std::min(scale, drawnWidth - x * scale));
+        }
+
+        const uint32_t *plain = row.data();
+        if (options.crtMask)
+        {
+            MultiplyPixels(row.data(), maskFactors.data(), maskedRow.data(), width);
+            plain = maskedRow.data();
+        }
+        if (shaded)
+        {
+            MultiplyPixels(row.data(), shadeFactors.data(), shadedRow.data(), width);
+        }
+
+        for (unsigned int line = 0; line < scale && y * scale + line < drawnHeight; ++line)
+        {
+            const uint32_t *output = shaded && line == scale - 1 ? shadedRow.data() : plain;
+            std::memcpy(Line(top + y * scale + line), output, width * sizeof(uint32_t));
+        }
+    }
+}
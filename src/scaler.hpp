@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "chip8.hpp"
+
+enum class ScaleFilter
+{
+    Nearest,
+    Scale2x
+};
+
+/** @brief Look of the CPU render pipeline.
+ *
+ *  filter     Nearest repeats pixels, Scale2x smooths diagonals with EPX first
+ *  scanlines  percent the last output row of every pixel row is darkened by
+ *  crtMask    aperture grille that dims two of three colour channels per column
+ *  ghosting   percent of last frame's colour kept per frame, hides flicker
+ *  palette    RGBA8888 colour of each plane combination
+ */
+struct ScalerOptions
+{
+    ScaleFilter filter = ScaleFilter::Nearest;
+    unsigned int scanlines = 0;
+    bool crtMask = false;
+    unsigned int ghosting = 0;
+    uint32_t palette[1u << VIDEO_PLANES] = {0x000000FF, 0xFFFFFFFF, 0xAAAAAAFF, 0x555555FF};
+};
+
+bool ParseScaleFilter(const char *name, ScaleFilter &filter);
+bool ParsePalette(const char *colors, uint32_t *palette);
+
+/** @brief Renders framebuffer straight at output size on the CPU, so the
+ *         texture it fills only needs to be copied to the window. Every
+ *         source row is expanded, masked and shaded once and then copied
+ *         to each output row it covers, with SSE2 kernels where available.
+ */
+class Scaler
+{
+private:
+    ScalerOptions options;
+    unsigned int width;
+    unsigned int height;
+
+    uint32_t source[HIRES_VIDEO_SIZE];
+    uint32_t doubled[HIRES_VIDEO_SIZE * 4];
+    uint32_t ghost[HIRES_VIDEO_SIZE * 4];
+    unsigned int ghostWidth{};
+    unsigned int ghostHeight{};
+
+    std::vector<uint32_t> row;
+    std::vector<uint32_t> maskedRow;
+    std::vector<uint32_t> shadedRow;
+    // Per output pixel and byte multipliers out of 256
+    std::vector<uint16_t> maskFactors;
+    std::vector<uint16_t> shadeFactors;
+
+    void Scale2x(unsigned int sourceWidth, unsigned int sourceHeight);
+    void Ghost(uint32_t *image, unsigned int imageWidth, unsigned int imageHeight);
+
+public:
+    Scaler(unsigned int width, unsigned int height, const ScalerOptions &options);
+    void Render(const Chip8Base &chip8, uint32_t *pixels, int pitch);
+};
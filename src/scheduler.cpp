@@ -0,0 +1,259 @@
+#include "scheduler.hpp"
+
+// Fx07, 3x00 and jump back take this many ticks per round
+const unsigned int TIMER_LOOP_TICKS = 3;
+
+Scheduler::Scheduler(unsigned int ticksPerFrame) : ticksPerFrame(ticksPerFrame)
+{
+}
+
+Scheduler::~Scheduler()
+{
+    for (Session &session : sessions)
+    {
+        session.task.handle.destroy();
+    }
+}
+
+/// @brief Take ownership of machine, it starts running with the next frame
+unsigned int Scheduler::Add(std::unique_ptr<Chip8Base> chip8)
+{
+    unsigned int id = sessions.size();
+    sessions.emplace_back();
+    sessions[id].chip8 = std::move(chip8);
+    sessions[id].clock = frameStart;
+    sessions[id].task = Run(id);
+    nextFrame.push_back(id);
+    return id;
+}
+
+/// @brief Hold keys from the start of the next frame, waking a session waiting in Fx0A
+void Scheduler::SetKeys(unsigned int id, uint16_t keys)
+{
+    Session &session = sessions[id];
+    session.keys = keys;
+    if (!session.keysChanged)
+    {
+        session.keysChanged = true;
+        keyEvents.push_back(id);
+    }
+}
+
+/// @brief Catch session up to tick by counting its timers down and queue it to run
+void Scheduler::Wake(unsigned int id, uint64_t tick)
+{
+    Session &session = sessions[id];
+    if (tick > session.clock)
+    {
+        session.chip8->ElapseTimers(tick - session.clock);
+        ticksSkipped += tick - session.clock;
+        session.clock = tick;
+    }
+    session.wait = Wait::Frame;
+    ready.push_back(id);
+}
+
+/** @brief Tick the delay timer spin loop at pc would leave on, "Fx07, 3x00,
+ *         jump to pc", or clock if pc does not start such a loop. Each round
+ *         only counts timers down and the round reading zero falls through.
+ */
+uint64_t Scheduler::TimerWaitEnd(const Chip8Base &chip8, uint64_t clock) const
+{
+    uint16_t pc = chip8.PC();
+    uint16_t load = chip8.OpcodeAt(pc);
+    if ((load & 0xF0FFu) != 0xF007u || chip8.DelayTimer() == 0 || pc + 6u > 0x1000u)
+    {
+        return clock;
+    }
+
+    unsigned int x = (load & 0x0F00u) >> 8u;
+    if (chip8.OpcodeAt(pc + 2) != (0x3000u | (x << 8u)) || chip8.OpcodeAt(pc + 4) != (0x1000u | pc))
+    {
+        return clock;
+    }
+
+    uint64_t rounds = (chip8.DelayTimer() + TIMER_LOOP_TICKS - 1) / TIMER_LOOP_TICKS;
+    return clock + rounds * TIMER_LOOP_TICKS;
+}
+
+void Scheduler::Park::await_suspend(std::coroutine_handle<>) const
+{
+    scheduler.sessions[session].wait = wait;
+    scheduler.sessions[session].wakeTick = wakeTick;
+    if (wait == Wait::Frame)
+    {
+        scheduler.nextFrame.push_back(session);
+    }
+    else if (wait == Wait::Timer)
+    {
+        scheduler.timers.push({wakeTick, session});
+    }
+    // Key waits are only found again through SetKeys
+}
+
+/// @brief Body of every session, runs its machine up to the end of each frame
+Scheduler::Task Scheduler::Run(unsigned int id)
+{
+    while (true)
+    {
+        // Sessions may have grown while suspended so look this one up again
+        Session &session = sessions[id];
+        Chip8Base &chip8 = *session.chip8;
+        Wait wait = Wait::Frame;
+        uint64_t wakeTick = frameEnd;
+
+        while (session.clock < frameEnd)
+        {
+            uint64_t timerEnd = TimerWaitEnd(chip8, session.clock);
+            // Ending right on the frame still parks so Vx is caught up properly
+            if (timerEnd >= frameEnd)
+            {
+                wait = Wait::Timer;
+                wakeTick = timerEnd;
+                break;
+            }
+            if (timerEnd > session.clock)
+            {
+                chip8.ElapseTimers(timerEnd - session.clock);
+                ticksSkipped += timerEnd - session.clock;
+                session.clock = timerEnd;
+                continue;
+            }
+
+            uint16_t pc = chip8.PC();
+            chip8.Tick();
+            ++session.clock;
+            ++ticksExecuted;
+
+            // Fx0A repeats itself while no key is held
+            if (chip8.PC() == pc && (chip8.OpcodeAt(pc) & 0xF0FFu) == 0xF00Au)
+            {
+                wait = Wait::Key;
+                break;
+            }
+        }
+
+        co_await Park{*this, id, wait, wakeTick};
+    }
+}
+
+/** @brief Run one frame. Key events are applied first, then sessions whose
+ *         timer wait ends within the frame are woken and every session
+ *         that is ready runs until the frame ends or it waits again.
+ */
+void Scheduler::RunFrame()
+{
+    frameEnd = frameStart + ticksPerFrame;
+    ready.swap(nextFrame);
+    nextFrame.clear();
+
+    for (unsigned int id : keyEvents)
+    {
+        Session &session = sessions[id];
+        session.keysChanged = false;
+        for (unsigned int key = 0; key < KEYPAD_SIZE; ++key)
+        {
+            session.chip8->keypad[key] = (session.keys >> key) & 0x1u;
+        }
+        if (session.wait == Wait::Key && session.keys)
+        {
+            Wake(id, frameStart);
+        }
+    }
+    keyEvents.clear();
+
+    while (!timers.empty() && timers.top().first < frameEnd)
+    {
+        auto [tick, id] = timers.top();
+        timers.pop();
+        // CatchUp may have ended this wait early, Wake ends duplicates
+        if (sessions[id].wait == Wait::Timer && sessions[id].wakeTick == tick)
+        {
+            Wake(id, tick);
+        }
+    }
+
+    lastActive = ready.size();
+    for (unsigned int id : ready)
+    {
+        sessions[id].task.handle.resume();
+    }
+    ready.clear();
+    frameStart = frameEnd;
+}
+
+/** @brief Bring waiting session to the start of the current frame, so its
+ *         machine looks like it ran every tick. A key wait only needs its
+ *         timers counted down. A timer wait counts all but the last round
+ *         and runs that and any partial round, so Vx holds what the last
+ *         Fx07 read, and the session goes back to running every frame.
+ */
+void Scheduler::CatchUp(unsigned int id)
+{
+    Session &session = sessions[id];
+    if (session.wait == Wait::Frame || session.clock >= frameStart)
+    {
+        return;
+    }
+
+    uint64_t ticks = frameStart - session.clock;
+    uint64_t run = 0;
+    if (session.wait == Wait::Timer)
+    {
+        run = ticks % TIMER_LOOP_TICKS;
+        if (ticks >= TIMER_LOOP_TICKS)
+        {
+            run += TIMER_LOOP_TICKS;
+        }
+    }
+
+    session.chip8->ElapseTimers(ticks - run);
+    ticksSkipped += ticks - run;
+    for (uint64_t tick = 0; tick < run; ++tick)
+    {
+        session.chip8->Tick();
+    }
+    ticksExecuted += run;
+    session.clock = frameStart;
+
+    if (session.wait == Wait::Timer)
+    {
+        // Leaves its entry in timers behind, RunFrame skips it
+        session.wait = Wait::Frame;
+        nextFrame.push_back(id);
+    }
+}
+
+/// @brief Machine of session as of the start of the next frame
+const Chip8Base &Scheduler::Machine(unsigned int id)
+{
+    CatchUp(id);
+    return *sessions[id].chip8;
+}
+
+Scheduler::Wait Scheduler::Waiting(unsigned int id) const
+{
+    return sessions[id].wait;
+}
+
+size_t Scheduler::Sessions() const
+{
+    return sessions.size();
+}
+
+/// @brief Sessions resumed by the last frame
+size_t Scheduler::LastActive() const
+{
+    return lastActive;
+}
+
+uint64_t Scheduler::TicksExecuted() const
+{
+    return ticksExecuted;
+}
+
+/// @brief Ticks sessions spent waiting that were only counted, not run
+uint64_t Scheduler::TicksSkipped() const
+{
+    return ticksSkipped;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "chip8.hpp"
+
+/** @brief Cooperative scheduler running many machines as coroutines on the
+ *         calling thread. Time is counted in ticks, one frame is
+ *         ticksPerFrame of them and every session gets a frame worth per
+ *         RunFrame. A session suspends when its frame budget is used up,
+ *         when it waits for a key in Fx0A or when it spins on the delay
+ *         timer past the end of the frame. Waiting sessions cost nothing
+ *         until a key event or their timer wakes them, so a frame costs
+ *         work proportional to the sessions that actually run.
+ *
+ *         Skipped ticks only count the timers down, which is exactly what
+ *         a repeating Fx0A or the "Fx07, 3x00, jump back" loop would have
+ *         done, so sessions end up in the same state as running every tick.
+ */
+class Scheduler
+{
+public:
+    /// @brief Coroutine handle owned by the scheduler
+    struct Task
+    {
+        struct promise_type
+        {
+            Task get_return_object()
+            {
+                return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { throw; }
+        };
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    enum class Wait
+    {
+        Frame,
+        Key,
+        Timer
+    };
+
+    Scheduler(unsigned int ticksPerFrame);
+    ~Scheduler();
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    unsigned int Add(std::unique_ptr<Chip8Base> chip8);
+    void SetKeys(unsigned int session, uint16_t keys);
+    void RunFrame();
+    const Chip8Base &Machine(unsigned int session);
+    Wait Waiting(unsigned int session) const;
+    size_t Sessions() const;
+    size_t LastActive() const;
+    uint64_t TicksExecuted() const;
+    uint64_t TicksSkipped() const;
+
+private:
+    struct Session
+    {
+        std::unique_ptr<Chip8Base> chip8;
+        Task task;
+        uint64_t clock{};
+        uint64_t wakeTick{};
+        Wait wait = Wait::Frame;
+        bool keysChanged{};
+        uint16_t keys{};
+    };
+
+    /// @brief Suspends the running session and files it under what it waits for
+    struct Park
+    {
+        Scheduler &scheduler;
+        unsigned int session;
+        Wait wait;
+        uint64_t wakeTick;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) const;
+        void await_resume() const noexcept {}
+    };
+
+    Task Run(unsigned int session);
+    void Wake(unsigned int session, uint64_t tick);
+    void CatchUp(unsigned int session);
+    uint64_t TimerWaitEnd(const Chip8Base &chip8, uint64_t clock) const;
+
+    const unsigned int ticksPerFrame;
+    uint64_t frameStart{};
+    uint64_t frameEnd{};
+    std::vector<Session> sessions;
+    std::vector<unsigned int> ready;
+    std::vector<unsigned int> nextFrame;
+    std::vector<unsigned int> keyEvents;
+    // Timer waits ordered by tick they end on
+    std::priority_queue<std::pair<uint64_t, unsigned int>, std::vector<std::pair<uint64_t, unsigned int>>,
+                        std::greater<std::pair<uint64_t, unsigned int>>>
+        timers;
+    size_t lastActive{};
+    uint64_t ticksExecuted{};
+    uint64_t ticksSkipped{};
+};
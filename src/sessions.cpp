@@ -0,0 +1,156 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "scheduler.hpp"
+
+const unsigned int DEFAULT_SESSIONS = 1000;
+const unsigned int DEFAULT_FRAMES = 600;
+const unsigned int DEFAULT_TICKS_PER_FRAME = 4;
+// Every session presses one key for a frame this often, staggered by session
+const unsigned int INPUT_INTERVAL = 60;
+const unsigned int VERIFY_SESSIONS = 8;
+
+/// @brief Keys session holds in given frame
+uint16_t ScriptedKeys(unsigned int session, unsigned int frame)
+{
+    if ((frame + session) % INPUT_INTERVAL != 0)
+    {
+        return 0;
+    }
+    return 1u << ((frame / INPUT_INTERVAL + session) % KEYPAD_SIZE);
+}
+
+/** @brief Run many copies of a ROM on one thread through the coroutine
+ *         scheduler with scripted key presses and report how many sessions
+ *         actually had to run per frame.
+ *
+ *  usage: sessions ROM [options]
+ *    --profile NAME     quirk profile, as for main
+ *    --sessions N       machines to run
+ *    --frames N         frames to run
+ *    --ticks N          ticks per frame
+ *    --verify           also run the first sessions tick by tick and compare
+ */
+int main(int argc, char **argv)
+{
+    const char *romFilename = nullptr;
+    const char *profileName = nullptr;
+    unsigned int sessionCount = DEFAULT_SESSIONS;
+    unsigned int frames = DEFAULT_FRAMES;
+    unsigned int ticksPerFrame = DEFAULT_TICKS_PER_FRAME;
+    bool verify = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--profile") == 0 && hasValue)
+            profileName = argv[++i];
+        else if (std::strcmp(argv[i], "--sessions") == 0 && hasValue)
+            sessionCount = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+            frames = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--ticks") == 0 && hasValue)
+            ticksPerFrame = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--verify") == 0)
+            verify = true;
+        else
+            romFilename = argv[i];
+    }
+
+    if (!romFilename)
+    {
+        std::cerr << "ERROR: Missing ROM argument" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    QuirkProfile profile = QuirkProfile::Chip8;
+    if (profileName && !ParseQuirkProfile(profileName, profile))
+    {
+        std::cerr << "ERROR: Unknown quirk profile, expected chip8, vip, schip or xochip" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::unique_ptr<Chip8Base> loaded = CreateChip8(profile);
+    try
+    {
+        loaded->LoadROM(romFilename);
+    }
+    catch (const char *message)
+    {
+        std::cerr << "ERROR: " << message << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    Scheduler scheduler(ticksPerFrame);
+    std::vector<std::unique_ptr<Chip8Base>> references;
+    for (unsigned int i = 0; i < sessionCount; ++i)
+    {
+        std::unique_ptr<Chip8Base> chip8 = loaded->Clone();
+        chip8->Seed(i);
+        if (verify && i < VERIFY_SESSIONS)
+        {
+            references.push_back(chip8->Clone());
+        }
+        scheduler.Add(std::move(chip8));
+    }
+
+    uint64_t activeTotal = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int frame = 0; frame < frames; ++frame)
+    {
+        for (unsigned int i = 0; i < sessionCount; ++i)
+        {
+            // Only send changes, like an input queue would
+            if (ScriptedKeys(i, frame) != (frame ? ScriptedKeys(i, frame - 1) : 0))
+            {
+                scheduler.SetKeys(i, ScriptedKeys(i, frame));
+            }
+        }
+        scheduler.RunFrame();
+        activeTotal += scheduler.LastActive();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "LOG: " << sessionCount << " sessions, " << frames << " frames in " << seconds * 1000 << "ms" << std::endl
+              << "LOG: " << (frames ? activeTotal / frames : 0) << " sessions active per frame on average" << std::endl
+              << "LOG: " << scheduler.TicksExecuted() << " ticks executed, " << scheduler.TicksSkipped() << " skipped while waiting" << std::endl
+              << "LOG: " << sessionCount * (frames / seconds) << " session frames/s" << std::endl;
+
+    if (verify)
+    {
+        static Chip8State expected;
+        static Chip8State actual;
+        unsigned int mismatches = 0;
+        for (unsigned int i = 0; i < references.size(); ++i)
+        {
+            Chip8Base &reference = *references[i];
+            for (unsigned int frame = 0; frame < frames; ++frame)
+            {
+                for (unsigned int key = 0; key < KEYPAD_SIZE; ++key)
+                {
+                    reference.keypad[key] = (ScriptedKeys(i, frame) >> key) & 0x1u;
+                }
+                for (unsigned int tick = 0; tick < ticksPerFrame; ++tick)
+                {
+                    reference.Tick();
+                }
+            }
+
+            reference.GetState(expected);
+            scheduler.Machine(i).GetState(actual);
+            if (std::memcmp(&expected, &actual, sizeof(Chip8State)) != 0 ||
+                reference.OutOfRangeAccesses() != scheduler.Machine(i).OutOfRangeAccesses())
+            {
+                std::cerr << "ERROR: session " << i << " differs from running every tick" << std::endl;
+                ++mismatches;
+            }
+        }
+        std::cout << "LOG: verified " << references.size() - mismatches << " of " << references.size() << " sessions" << std::endl;
+        return mismatches ? EXIT_FAILURE : 0;
+    }
+
+    return 0;
+}
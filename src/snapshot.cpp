@@ -0,0 +1,74 @@
+#include "snapshot.hpp"
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+const char SNAPSHOT_MAGIC[4] = {'C', '8', 'S', 'S'};
+const uint32_t SNAPSHOT_VERSION = 2;
+
+/** @brief Header in front of raw Chip8State. State is stored as is up to
+ *         the end of the memory its profile addresses, so snapshot can only
+ *         be loaded by the same build, which is what size check guards against
+ */
+struct SnapshotHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t stateSize;
+    uint32_t profile;
+};
+
+/// @brief Bytes of Chip8State that hold anything for given profile
+static size_t StoredSize(QuirkProfile profile)
+{
+    return offsetof(Chip8State, memory) + ProfileMemorySize(profile);
+}
+
+/// @brief Write machine state and its quirk profile to file
+void SaveSnapshot(const char *filename, QuirkProfile profile, const Chip8State &state)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw "Snapshot could not be created";
+    }
+
+    SnapshotHeader header;
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.stateSize = sizeof(Chip8State);
+    header.profile = static_cast<uint32_t>(profile);
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(&state), StoredSize(profile));
+    if (!file)
+    {
+        throw "Snapshot could not be written";
+    }
+};
+
+/// @brief Read machine state from file and return profile it was taken with
+QuirkProfile LoadSnapshot(const char *filename, Chip8State &state)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw "Snapshot could not be opened";
+    }
+
+    SnapshotHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAPSHOT_VERSION || header.stateSize != sizeof(Chip8State) ||
+        header.profile > static_cast<uint32_t>(QuirkProfile::XOChip))
+    {
+        throw "Snapshot is not compatible with this build";
+    }
+
+    file.read(reinterpret_cast<char *>(&state), StoredSize(static_cast<QuirkProfile>(header.profile)));
+    if (!file)
+    {
+        throw "Snapshot is truncated";
+    }
+    return static_cast<QuirkProfile>(header.profile);
+};
@@ -0,0 +1,5 @@
+#pragma once
+#include "chip8.hpp"
+
+void SaveSnapshot(const char *filename, QuirkProfile profile, const Chip8State &state);
+QuirkProfile LoadSnapshot(const char *filename, Chip8State &state);
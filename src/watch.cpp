@@ -0,0 +1,94 @@
+#include "watch.hpp"
+
+#ifdef __linux__
+#include <climits>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifndef __linux__
+const std::chrono::milliseconds WATCH_POLL_INTERVAL(100);
+#endif
+
+#ifdef __linux__
+FileWatcher::FileWatcher(const char *filename)
+{
+    std::string path(filename);
+    size_t separator = path.find_last_of('/');
+    std::string directory = separator == std::string::npos ? "." : path.substr(0, separator + 1);
+    name = separator == std::string::npos ? path : path.substr(separator + 1);
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        throw "File watch could not be started";
+    }
+    watch = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watch < 0)
+    {
+        close(fd);
+        throw "Directory of file could not be watched";
+    }
+};
+
+FileWatcher::~FileWatcher()
+{
+    close(fd);
+};
+
+/// @brief Drain pending events without blocking, true if any was about the file
+bool FileWatcher::Changed()
+{
+    alignas(inotify_event) char buffer[sizeof(inotify_event) + NAME_MAX + 1];
+    bool changed = false;
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char *position = buffer; position < buffer + length;)
+        {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(position);
+            // Created files are only complete once they are closed
+            if (event->len && name == event->name && !(event->mask & IN_CREATE))
+            {
+                changed = true;
+            }
+            position += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
+};
+#else
+FileWatcher::FileWatcher(const char *filename) : path(filename)
+{
+    std::error_code error;
+    lastWrite = std::filesystem::last_write_time(path, error);
+    if (error)
+    {
+        throw "File could not be watched";
+    }
+    lastPoll = std::chrono::steady_clock::now();
+};
+
+FileWatcher::~FileWatcher() = default;
+
+/// @brief Compare modification time, looked at once per poll interval
+bool FileWatcher::Changed()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastPoll < WATCH_POLL_INTERVAL)
+    {
+        return false;
+    }
+    lastPoll = now;
+
+    std::error_code error;
+    std::filesystem::file_time_type write = std::filesystem::last_write_time(path, error);
+    // File may be missing for a moment while editor replaces it
+    if (error || write == lastWrite)
+    {
+        return false;
+    }
+    lastWrite = write;
+    return true;
+};
+#endif
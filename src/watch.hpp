@@ -0,0 +1,32 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+#ifndef __linux__
+#include <filesystem>
+#endif
+
+/** @brief Tells when a file was written. On Linux inotify watches the
+ *         directory, so editors that save by renaming a new file over the
+ *         old one are seen too. Elsewhere the modification time is polled.
+ */
+class FileWatcher
+{
+private:
+#ifdef __linux__
+    int fd = -1;
+    int watch = -1;
+    std::string name;
+#else
+    std::filesystem::path path;
+    std::filesystem::file_time_type lastWrite;
+    std::chrono::steady_clock::time_point lastPoll;
+#endif
+
+public:
+    FileWatcher(const char *filename);
+    ~FileWatcher();
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+    bool Changed();
+};